@@ -35,8 +35,28 @@
 // Operating Instructions:
 // -----------------------
 // - Connect the board via USB to your PC. It should be detected as a HID device with
-//   keyboard, mouse and joystick interface.
+//   keyboard, mouse and joystick interface plus a vendor-defined Raw HID interface.
+// - Keymap, key colors and timing parameters can be changed at runtime via the Raw
+//   HID interface (see src/usb_rawhid.h for the command protocol). Keymap entries of
+//   type MAP_DEFAULT keep the macro functions below. Changes are stored in DataFlash
+//   and survive power cycles.
 // - Press a macro key or turn the knob and see what happens.
+// - The knob switch recognizes single, double and triple clicks, long presses and
+//   turning the knob while it is pressed.
+// - While the host is asleep (USB suspend) the NeoPixels are off and the MacroPad
+//   sleeps. If the host allows remote wakeup, key 4, 5, 6 or the encoder switch
+//   wake it up.
+// - With USB_MIDI enabled in src/config.h the MacroPad is also a USB MIDI device.
+//   Keys and the knob can be mapped to notes and (relative) control changes at
+//   runtime (keymap types MAP_MIDI_NOTE, MAP_MIDI_CC and MAP_MIDI_REL).
+// - With USB_CDC enabled in src/config.h (instead of USB_MIDI) a debug console is
+//   available as a virtual serial port, type "help" (see src/usb_cdc.h).
+// - With USB_WEBUSB enabled in src/config.h the configuration commands are also
+//   available via a WebUSB/WinUSB vendor interface, so a browser-based or Windows
+//   configuration tool needs no driver installation (see src/usb_rawhid.h).
+// - The first three pixels of the encoder ring show Num, Caps and Scroll Lock.
+// - The host can take over the NeoPixels with streamed frames via Raw HID, e.g.
+//   for build status or on-air indicators (see src/ledstream.h).
 // - To enter bootloader hold down rotary encoder switch while connecting the 
 //   MacroPad to USB. All NeoPixels will light up white as long as the device is in 
 //   bootloader mode (about 10 seconds).
@@ -50,8 +70,20 @@
 #include "src/config.h"                     // user configurations
 #include "src/system.h"                     // system functions
 #include "src/delay.h"                      // delay functions
+#include "src/timer.h"                      // millisecond system tick
+#include "src/encoder.h"                    // rotary encoder with gestures
 #include "src/neo.h"                        // NeoPixel functions
 #include "src/usb_composite.h"              // USB HID composite functions
+#include "src/kbd_strings.h"                // pre-encoded macro strings
+#include "src/unicode.h"                    // Unicode text entry
+#include "src/mousekeys.h"                  // mouse keys motion engine
+#include "src/usb_rawhid.h"                 // USB Raw HID configuration interface
+#include "src/usb_midi.h"                   // USB MIDI interface
+#include "src/usb_cdc.h"                    // USB CDC-ACM debug console
+#include "src/ledstream.h"                  // host-driven NeoPixel frames
+#include "src/settings.h"                   // runtime settings
+#include "src/keymap.h"                     // runtime keymap
+#include "src/stats.h"                      // runtime statistics
 
 // Prototypes for used interrupts
 void USB_interrupt(void);
@@ -59,6 +91,11 @@ void USB_ISR(void) __interrupt(INT_NO_USB) {
   USB_interrupt();
 }
 
+void TIM_interrupt(void);
+void TMR2_ISR(void) __interrupt(INT_NO_TMR2) {
+  TIM_interrupt();
+}
+
 #pragma disable_warning 110                 // Keep calm, EVELYN!
 
 // ===================================================================================
@@ -66,6 +103,12 @@ void USB_ISR(void) __interrupt(INT_NO_USB) {
 // ===================================================================================
 /*
 // The list of available USB HID functions can be found in src/usb_composite.h
+// Fixed text is best typed with KBD_play(STR_...), the strings are defined in
+// src/kbd_strings.txt and compiled by the makefile. Text with non-ASCII characters
+// can be typed with UNI_print("..."), select the input method of the host with
+// UNI_setMode() or UNI_nextMode() (see src/unicode.h).
+// Held keys can move the mouse pointer with MK_press(MK_UP) etc. in the PRESSED and
+// MK_release() in the RELEASED functions (see src/mousekeys.h).
 // The keys are enumerated the following way:
 // +---+---+---+    -----
 // | 3 | 2 | 1 |  /       \
@@ -81,7 +124,7 @@ inline void KEY1_PRESSED() {
 
 // Define action(s) if key1 was released
 inline void KEY1_RELEASED() {
-  CON_release();
+  CON_release(CON_MEDIA_STOP);
 }
 
 // Define action(s) when key1 is held
@@ -95,7 +138,7 @@ inline void KEY2_PRESSED() {
 
 // Define action(s) if key2 was released
 inline void KEY2_RELEASED() {
-  CON_release();
+  CON_release(CON_MEDIA_PLAY);
 }
 
 // Define action(s) when key2 is held
@@ -109,7 +152,7 @@ inline void KEY3_PRESSED() {
 
 // Define action(s) if key3 was released
 inline void KEY3_RELEASED() {
-  CON_release();
+  CON_release(CON_MEDIA_PAUSE);
 }
 
 // Define action(s) when key3 is held
@@ -158,8 +201,95 @@ inline void KEY6_RELEASED() {
 inline void KEY6_HOLD() {
 }
 
+#if ENC_KNOB == ENC_KNOB_SCROLL
+// Rotary encoder example -> high-resolution scroll wheel
+// -------------------------------------------------------
+// Each detent scrolls ENC_SCROLL_STEP/8 notches. Hosts with high-resolution
+// scrolling (Windows, Linux) scroll smoothly, others get whole notches only.
+
+// Define action(s) if encoder was rotated clockwise
+inline void ENC_CW_ACTION() {
+  MOUSE_scroll(-ENC_SCROLL_STEP, 0);                  // scroll down
+}
+
+// Define action(s) after encoder was rotated clockwise
+inline void ENC_CW_RELEASED() {
+}
+
+// Define action(s) if encoder was rotated counter-clockwise
+inline void ENC_CCW_ACTION() {
+  MOUSE_scroll(ENC_SCROLL_STEP, 0);                   // scroll up
+}
+
+// Define action(s) after encoder was rotated counter-clockwise
+inline void ENC_CCW_RELEASED() {
+}
+
+// Define action(s) if encoder was rotated clockwise while switch is pressed
+inline void ENC_PUSH_CW_ACTION() {
+  MOUSE_scroll(0, ENC_SCROLL_STEP);                   // scroll right
+}
+
+// Define action(s) after encoder was rotated clockwise while switch is pressed
+inline void ENC_PUSH_CW_RELEASED() {
+}
+
+// Define action(s) if encoder was rotated counter-clockwise while switch is pressed
+inline void ENC_PUSH_CCW_ACTION() {
+  MOUSE_scroll(0, -ENC_SCROLL_STEP);                  // scroll left
+}
+
+// Define action(s) after encoder was rotated counter-clockwise while switch is pressed
+inline void ENC_PUSH_CCW_RELEASED() {
+}
+
+#elif ENC_KNOB == ENC_KNOB_DIAL
+// Rotary encoder example -> Windows radial controller (Surface Dial)
+// ------------------------------------------------------------------
+// Each detent turns the dial by DIAL_STEP (0.1 degree units). Detents are
+// accumulated while the endpoint is busy and sent by DIAL_update() in the main
+// loop, a click of the encoder switch clicks the dial button.
+
+// Define action(s) if encoder was rotated clockwise
+inline void ENC_CW_ACTION() {
+  DIAL_cw();                                          // turn dial clockwise
+}
+
+// Define action(s) after encoder was rotated clockwise
+inline void ENC_CW_RELEASED() {
+}
+
+// Define action(s) if encoder was rotated counter-clockwise
+inline void ENC_CCW_ACTION() {
+  DIAL_ccw();                                         // turn dial counter-clockwise
+}
+
+// Define action(s) after encoder was rotated counter-clockwise
+inline void ENC_CCW_RELEASED() {
+}
+
+// Define action(s) if encoder was rotated clockwise while switch is pressed
+inline void ENC_PUSH_CW_ACTION() {
+  DIAL_cw();                                          // turn dial clockwise
+}
+
+// Define action(s) after encoder was rotated clockwise while switch is pressed
+inline void ENC_PUSH_CW_RELEASED() {
+}
+
+// Define action(s) if encoder was rotated counter-clockwise while switch is pressed
+inline void ENC_PUSH_CCW_ACTION() {
+  DIAL_ccw();                                         // turn dial counter-clockwise
+}
+
+// Define action(s) after encoder was rotated counter-clockwise while switch is pressed
+inline void ENC_PUSH_CCW_RELEASED() {
+}
+
+#else
 // Rotary encoder example -> volume control knob
 // ---------------------------------------------
+// (select another knob function with ENC_KNOB in src/config.h)
 
 // Define action(s) if encoder was rotated clockwise
 inline void ENC_CW_ACTION() {
@@ -168,7 +298,7 @@ inline void ENC_CW_ACTION() {
 
 // Define action(s) after encoder was rotated clockwise
 inline void ENC_CW_RELEASED() {
-  CON_release();                                      // release VOLUME UP KEY
+  CON_release(CON_VOL_UP);                            // release VOLUME UP KEY
 }
 
 // Define action(s) if encoder was rotated counter-clockwise
@@ -178,17 +308,57 @@ inline void ENC_CCW_ACTION() {
 
 // Define action(s) after encoder was rotated counter-clockwise
 inline void ENC_CCW_RELEASED() {
-  CON_release();                                      // release VOLUME DOWN KEY
+  CON_release(CON_VOL_DOWN);                          // release VOLUME DOWN KEY
 }
 
-// Define action(s) if encoder switch was pressed
-inline void ENC_SW_PRESSED() {
-  CON_press(CON_VOL_MUTE);                            // press VOLUME MUTE key
+// Define action(s) if encoder was rotated clockwise while switch is pressed
+inline void ENC_PUSH_CW_ACTION() {
+  CON_press(CON_MEDIA_NEXT);                          // press NEXT TRACK key
 }
 
-// Define action(s) if encoder switch was released
-inline void ENC_SW_RELEASED() {
-  CON_release();                                      // release VOLUME MUTE key
+// Define action(s) after encoder was rotated clockwise while switch is pressed
+inline void ENC_PUSH_CW_RELEASED() {
+  CON_release(CON_MEDIA_NEXT);                        // release NEXT TRACK key
+}
+
+// Define action(s) if encoder was rotated counter-clockwise while switch is pressed
+inline void ENC_PUSH_CCW_ACTION() {
+  CON_press(CON_MEDIA_PREV);                          // press PREVIOUS TRACK key
+}
+
+// Define action(s) after encoder was rotated counter-clockwise while switch is pressed
+inline void ENC_PUSH_CCW_RELEASED() {
+  CON_release(CON_MEDIA_PREV);                        // release PREVIOUS TRACK key
+}
+#endif
+
+// Rotary encoder switch gestures
+// ------------------------------
+
+// Define action(s) if encoder switch was clicked once
+inline void ENC_SW_CLICK() {
+  #if ENC_KNOB == ENC_KNOB_DIAL
+  DIAL_press();                                       // click dial button
+  DIAL_release();
+  #else
+  CON_type(CON_VOL_MUTE);                             // type VOLUME MUTE key
+  #endif
+}
+
+// Define action(s) if encoder switch was double-clicked
+inline void ENC_SW_DOUBLE_CLICK() {
+}
+
+// Define action(s) if encoder switch was triple-clicked
+inline void ENC_SW_TRIPLE_CLICK() {
+}
+
+// Define action(s) if encoder switch was held down for a long press
+inline void ENC_SW_LONG_PRESSED() {
+}
+
+// Define action(s) if encoder switch was released after a long press
+inline void ENC_SW_LONG_RELEASED() {
 }
 
 // ===================================================================================
@@ -198,6 +368,12 @@ inline void ENC_SW_RELEASED() {
 // Global NeoPixel brightness
 #define NEO_BRIGHT_KEYS   2         // NeoPixel brightness for keys (0..2)
 #define NEO_BRIGHT_ENC    0         // NeoPixel brightness for encoder ring (0..2)
+#define NEO_BRIGHT_LOCK   64        // brightness of lock indicators (0: off, ..255)
+
+// Encoder ring: NEO_RING_RAINBOW (rotates with each detent) or NEO_RING_GAUGE
+// (bar showing a level 0..255, changed by NEO_GAUGE_STEP per detent or by the host)
+#define NEO_RING_MODE     NEO_RING_RAINBOW
+#define NEO_GAUGE_STEP    8
 
 // Key colors (hue value: 0..191)
 #define NEO_KEY1          0         // red
@@ -207,26 +383,93 @@ inline void ENC_SW_RELEASED() {
 #define NEO_KEY5          128       // blue
 #define NEO_KEY6          160       // magenta
 
+// Default runtime settings (can be changed via the Raw HID interface)
+__code SET_DATA SET_defaults = {
+  .hue         = { NEO_KEY1, NEO_KEY2, NEO_KEY3, NEO_KEY4, NEO_KEY5, NEO_KEY6 },
+  .brightKeys  = NEO_BRIGHT_KEYS,
+  .brightEnc   = NEO_BRIGHT_ENC,
+  .scanDelay   = SCAN_DELAY_ms,
+  .encDebounce = ENC_DEBOUNCE_ms,
+  .clickGap    = ENC_CLICK_GAP_ms / 10,
+  .longPress   = ENC_LONG_PRESS_ms / 10,
+  .uniMode     = UNI_MODE,
+  .ringMode    = NEO_RING_MODE
+};                                          // keymap: all MAP_DEFAULT (0)
+
 // ===================================================================================
 // NeoPixel Functions
 // ===================================================================================
 
 uint8_t neoencoder = 0;                           // state of NeoPixel ring rotation
+uint8_t neogauge = 0xFF;                          // gauge position shown (0xFF: none)
+
+// Light up NeoPixel of pressed key
+void NEO_key_on(uint8_t key) {
+  if(LED_streaming) return;                       // host controls the pixels
+  NEO_writeHue(key, SET_data.hue[key], SET_data.brightKeys);
+  NEO_update();
+}
+
+// Switch off NeoPixel of released key
+void NEO_key_off(uint8_t key) {
+  if(LED_streaming) return;                       // host controls the pixels
+  NEO_clearPixel(key);
+  NEO_update();
+}
+
+// Gauge position of level (0..192: 16 steps per ring pixel)
+#define NEO_gauge_pos(level)  (((uint16_t)(level) * 193) >> 8)
 
 // Update NeoPixel ring colors
 void NEO_encoder_update(void) {
   uint8_t i, j;
-  j = neoencoder;
-  for(i=6; i<18; i++) {
-    NEO_writeHue(i, j, NEO_BRIGHT_ENC);
-    j += 16;
-    if(j >= 192) j -= 192;
+  if(LED_streaming) return;                       // host controls the pixels
+  if(SET_data.ringMode == NEO_RING_GAUGE) {
+    neogauge = NEO_gauge_pos(LED_gaugeLevel);
+    j = neogauge;
+    for(i=6; i<18; i++) {                         // green to red bar
+      if(j) NEO_writeHue(i, 64 - ((i - 6) * 5), SET_data.brightEnc);
+      else  NEO_clearPixel(i);
+      if(j < 16) {
+        if(j) NEO_dimPixel(i, j << 4);            // anti-aliased tip of the bar
+        j = 0;
+      }
+      else j -= 16;
+    }
+  }
+  else {
+    neogauge = 0xFF;
+    j = neoencoder;
+    for(i=6; i<18; i++) {
+      NEO_writeHue(i, j, SET_data.brightEnc);
+      j += 16;
+      if(j >= 192) j -= 192;
+    }
   }
+  #if NEO_BRIGHT_LOCK > 0
+  j = KBD_getState();                             // Num, Caps, Scroll Lock indicators
+  for(i=6; i<9; i++, j>>=1)                       // on first three ring pixels
+    if(j & 1) NEO_writeColor(i, NEO_BRIGHT_LOCK, NEO_BRIGHT_LOCK, NEO_BRIGHT_LOCK);
+  #endif
   NEO_update();
 }
 
+// Redraw ring only if the quantised gauge level or the ring mode has changed
+void NEO_gauge_update(void) {
+  if(SET_data.ringMode == NEO_RING_GAUGE) {
+    if(NEO_gauge_pos(LED_gaugeLevel) != neogauge) NEO_encoder_update();
+  }
+  else if(neogauge != 0xFF) NEO_encoder_update();
+}
+
 // Rotate NeoPixel ring clockwise
 void NEO_encoder_cw(void) {
+  if(SET_data.ringMode == NEO_RING_GAUGE) {
+    if(LED_gaugeLevel < 255 - NEO_GAUGE_STEP) LED_gaugeLevel += NEO_GAUGE_STEP;
+    else LED_gaugeLevel = 255;
+    NEO_gauge_update();
+    return;
+  }
   neoencoder += 8;
   if(neoencoder >= 192) neoencoder -= 192;
   NEO_encoder_update();
@@ -234,11 +477,71 @@ void NEO_encoder_cw(void) {
 
 // Rotate NeoPixel ring counter-clockwise
 void NEO_encoder_ccw(void) {
+  if(SET_data.ringMode == NEO_RING_GAUGE) {
+    if(LED_gaugeLevel > NEO_GAUGE_STEP) LED_gaugeLevel -= NEO_GAUGE_STEP;
+    else LED_gaugeLevel = 0;
+    NEO_gauge_update();
+    return;
+  }
   neoencoder -= 8;
   if(neoencoder >= 192) neoencoder -= 64;
   NEO_encoder_update();
 }
 
+// ===================================================================================
+// USB Suspend
+// ===================================================================================
+
+// Get pressed keys (bits 0..5) and encoder switch (bit 6)
+uint8_t KEY_getPressed(void) {
+  uint8_t pressed = 0;
+  if(!PIN_read(PIN_KEY1))   pressed |= 0x01;
+  if(!PIN_read(PIN_KEY2))   pressed |= 0x02;
+  if(!PIN_read(PIN_KEY3))   pressed |= 0x04;
+  if(!PIN_read(PIN_KEY4))   pressed |= 0x08;
+  if(!PIN_read(PIN_KEY5))   pressed |= 0x10;
+  if(!PIN_read(PIN_KEY6))   pressed |= 0x20;
+  if(!PIN_read(PIN_ENC_SW)) pressed |= 0x40;
+  return pressed;
+}
+
+// Sleep as long as the host suspends the bus. Wakes up on bus activity and, if the
+// host allowed remote wakeup, on key 4 (P1.5), key 5 (P1.4), key 6 (P3.2) and the
+// encoder switch (P3.3). A new press then wakes up the host, keys held since the
+// suspend or since the last attempt don't, so the host can stay suspended.
+void USB_suspend(void) {
+  uint8_t i, held, pressed;
+  CDC_log("suspend");
+  NEO_blank();                                    // NeoPixels off, keep buffer
+  EA = 0;                                         // safe mode must not be interrupted
+  SAFE_MOD  = 0x55;
+  SAFE_MOD  = 0xAA;                               // enter safe mode
+  WAKE_CTRL = USB_wakeupEnabled ? (WAKE_USB | WAKE_P14 | WAKE_P15 | WAKE_INT) : WAKE_USB;
+  SAFE_MOD  = 0x00;                               // terminate safe mode
+  EA = 1;
+  DLY_ms(2);                                      // resume signal needs 5ms bus idle,
+  held = KEY_getPressed();                        // suspend is detected after 3ms
+  while(USB_suspended) {
+    WDT_reset();                                  // reset watchdog
+    pressed = KEY_getPressed();
+    if(USB_wakeupEnabled && (pressed & ~held)) {  // new key press while suspended?
+      USB_wakeup();                               // signal resume to host
+      for(i=50; i && USB_suspended; i--) DLY_ms(1); // wait for host to resume bus
+    }
+    else if(pressed) DLY_ms(1);                   // held key would wake at once (level)
+    else SLEEP_now();                             // sleep until wake-up event
+    held = pressed;
+  }
+  EA = 0;
+  SAFE_MOD  = 0x55;
+  SAFE_MOD  = 0xAA;                               // enter safe mode
+  WAKE_CTRL = 0;                                  // disable wake-up sources
+  SAFE_MOD  = 0x00;                               // terminate safe mode
+  EA = 1;
+  NEO_update();                                   // restore NeoPixels
+  CDC_log("resume");
+}
+
 // ===================================================================================
 // Main Function
 // ===================================================================================
@@ -250,7 +553,6 @@ void main(void) {
   __bit key4last = 0;                             // last state of key 4
   __bit key5last = 0;                             // last state of key 5
   __bit key6last = 0;                             // last state of key 6
-  __bit isSwitchPressed = 0;                      // state of rotary encoder switch
   __idata uint8_t i;                              // temp variable
 
   // Setup
@@ -261,35 +563,42 @@ void main(void) {
 
   // Enter bootloader if rotary encoder switch is pressed
   if(!PIN_read(PIN_ENC_SW)) {                     // encoder switch pressed?
-    for(i=3*NEO_COUNT; i; i--) NEO_sendByte(127); // light up all pixels
+    NEO_fill(127);                                // light up all pixels
     BOOT_now();                                   // enter bootloader
   }
 
   // Init USB HID device
+  SET_load();                                     // load settings from DataFlash
+  TIM_init();                                     // start system tick
   HID_init();                                     // init USB HID device
-  DLY_ms(500);                                    // wait for Windows
+  #if USB_CDC
+  CDC_init();                                     // log reset cause
+  #endif
+  ENC_init();                                     // init rotary encoder
   WDT_start();                                    // start watchdog timer
   NEO_encoder_update();                           // set NeoPixel ring for encoder
 
   // Loop
   while(1) {
 
+    // Sleep while USB is suspended
+    // ----------------------------
+    if(USB_suspended) USB_suspend();              // sleep and wake up host on key
+
     // Handle key 1
     // ------------
     if(!PIN_read(PIN_KEY1) != key1last) {         // key state changed?
       key1last = !key1last;                       // update last state flag
       if(key1last) {                              // key was pressed?
-        NEO_writeHue(0, NEO_KEY1, NEO_BRIGHT_KEYS);    // light up corresponding NeoPixel
-        NEO_update();                             // update pixels
-        KEY1_PRESSED();                           // take proper action
+        NEO_key_on(0);                            // light up NeoPixel
+        if(!MAP_press(MAP_KEY1)) KEY1_PRESSED();  // take proper action
       }
       else {                                      // key was released?
-        NEO_clearPixel(0);                        // light up corresponding NeoPixel
-        NEO_update();                             // update pixels
-        KEY1_RELEASED();                          // take proper action
+        NEO_key_off(0);                           // switch off NeoPixel
+        if(!MAP_release(MAP_KEY1)) KEY1_RELEASED(); // take proper action
       }
     }
-    else if(key1last) {                           // key still being pressed?
+    else if(key1last && !MAP_isSet(MAP_KEY1)) {  // key still being pressed?
       KEY1_HOLD();                                // take proper action
     }
 
@@ -298,17 +607,15 @@ void main(void) {
     if(!PIN_read(PIN_KEY2) != key2last) {         // key state changed?
       key2last = !key2last;                       // update last state flag
       if(key2last) {                              // key was pressed?
-        NEO_writeHue(1, NEO_KEY2, NEO_BRIGHT_KEYS);    // light up corresponding NeoPixel
-        NEO_update();                             // update pixels
-        KEY2_PRESSED();                           // take proper action
+        NEO_key_on(1);                            // light up NeoPixel
+        if(!MAP_press(MAP_KEY2)) KEY2_PRESSED();  // take proper action
       }
       else {                                      // key was released?
-        NEO_clearPixel(1);                        // light up corresponding NeoPixel
-        NEO_update();                             // update pixels
-        KEY2_RELEASED();                          // take proper action
+        NEO_key_off(1);                           // switch off NeoPixel
+        if(!MAP_release(MAP_KEY2)) KEY2_RELEASED(); // take proper action
       }
     }
-    else if(key2last) {                           // key still being pressed?
+    else if(key2last && !MAP_isSet(MAP_KEY2)) {  // key still being pressed?
       KEY2_HOLD();                                // take proper action
     }
 
@@ -317,17 +624,15 @@ void main(void) {
     if(!PIN_read(PIN_KEY3) != key3last) {         // key state changed?
       key3last = !key3last;                       // update last state flag
       if(key3last) {                              // key was pressed?
-        NEO_writeHue(2, NEO_KEY3, NEO_BRIGHT_KEYS);    // light up corresponding NeoPixel
-        NEO_update();                             // update pixels
-        KEY3_PRESSED();                           // take proper action
+        NEO_key_on(2);                            // light up NeoPixel
+        if(!MAP_press(MAP_KEY3)) KEY3_PRESSED();  // take proper action
       }
       else {                                      // key was released?
-        NEO_clearPixel(2);                        // light up corresponding NeoPixel
-        NEO_update();                             // update pixels
-        KEY3_RELEASED();                          // take proper action
+        NEO_key_off(2);                           // switch off NeoPixel
+        if(!MAP_release(MAP_KEY3)) KEY3_RELEASED(); // take proper action
       }
     }
-    else if(key3last) {                           // key still being pressed?
+    else if(key3last && !MAP_isSet(MAP_KEY3)) {  // key still being pressed?
       KEY3_HOLD();                                // take proper action
     }
 
@@ -336,17 +641,15 @@ void main(void) {
     if(!PIN_read(PIN_KEY4) != key4last) {         // key state changed?
       key4last = !key4last;                       // update last state flag
       if(key4last) {                              // key was pressed?
-        NEO_writeHue(3, NEO_KEY4, NEO_BRIGHT_KEYS);    // light up corresponding NeoPixel
-        NEO_update();                             // update pixels
-        KEY4_PRESSED();                           // take proper action
+        NEO_key_on(3);                            // light up NeoPixel
+        if(!MAP_press(MAP_KEY4)) KEY4_PRESSED();  // take proper action
       }
       else {                                      // key was released?
-        NEO_clearPixel(3);                        // light up corresponding NeoPixel
-        NEO_update();                             // update pixels
-        KEY4_RELEASED();                          // take proper action
+        NEO_key_off(3);                           // switch off NeoPixel
+        if(!MAP_release(MAP_KEY4)) KEY4_RELEASED(); // take proper action
       }
     }
-    else if(key4last) {                           // key still being pressed?
+    else if(key4last && !MAP_isSet(MAP_KEY4)) {  // key still being pressed?
       KEY4_HOLD();                                // take proper action
     }
 
@@ -355,17 +658,15 @@ void main(void) {
     if(!PIN_read(PIN_KEY5) != key5last) {         // key state changed?
       key5last = !key5last;                       // update last state flag
       if(key5last) {                              // key was pressed?
-        NEO_writeHue(4, NEO_KEY5, NEO_BRIGHT_KEYS);    // light up corresponding NeoPixel
-        NEO_update();                             // update pixels
-        KEY5_PRESSED();                           // take proper action
+        NEO_key_on(4);                            // light up NeoPixel
+        if(!MAP_press(MAP_KEY5)) KEY5_PRESSED();  // take proper action
       }
       else {                                      // key was released?
-        NEO_clearPixel(4);                        // light up corresponding NeoPixel
-        NEO_update();                             // update pixels
-        KEY5_RELEASED();                          // take proper action
+        NEO_key_off(4);                           // switch off NeoPixel
+        if(!MAP_release(MAP_KEY5)) KEY5_RELEASED(); // take proper action
       }
     }
-    else if(key5last) {                           // key still being pressed?
+    else if(key5last && !MAP_isSet(MAP_KEY5)) {  // key still being pressed?
       KEY5_HOLD();                                // take proper action
     }
 
@@ -374,49 +675,82 @@ void main(void) {
     if(!PIN_read(PIN_KEY6) != key6last) {         // key state changed?
       key6last = !key6last;                       // update last state flag
       if(key6last) {                              // key was pressed?
-        NEO_writeHue(5, NEO_KEY6, NEO_BRIGHT_KEYS);    // light up corresponding NeoPixel
-        NEO_update();                             // update pixels
-        KEY6_PRESSED();                           // take proper action
+        NEO_key_on(5);                            // light up NeoPixel
+        if(!MAP_press(MAP_KEY6)) KEY6_PRESSED();  // take proper action
       }
       else {                                      // key was released?
-        NEO_clearPixel(5);                        // light up corresponding NeoPixel
-        NEO_update();                             // update pixels
-        KEY6_RELEASED();                          // take proper action
+        NEO_key_off(5);                           // switch off NeoPixel
+        if(!MAP_release(MAP_KEY6)) KEY6_RELEASED(); // take proper action
       }
     }
-    else if(key6last) {                           // key still being pressed?
+    else if(key6last && !MAP_isSet(MAP_KEY6)) {  // key still being pressed?
       KEY6_HOLD();                                // take proper action
     }
 
+    // Handle keyboard LEDs
+    // --------------------
+    if(KBD_ledEvent()) NEO_encoder_update();      // show lock states on change only
+    else NEO_gauge_update();                      // show gauge level set by host
+
     // Handle rotary encoder
     // ---------------------
-    if(!PIN_read(PIN_ENC_A)) {                    // encoder turned ?
-      if(PIN_read(PIN_ENC_B)) {                   // clockwise ?
-        ENC_CW_ACTION();                          // take proper action
+    switch(ENC_read()) {                          // get encoder event
+      case ENC_CW:                                // clockwise ?
+        if(!MAP_press(MAP_ENC_CW)) ENC_CW_ACTION(); // take proper action
         NEO_encoder_cw();                         // rotate NeoPixels
-        DLY_ms(5);                                // debounce
-        ENC_CW_RELEASED();                        // take proper action
-      }
-      else {                                      // counter-clockwise ?
-        ENC_CCW_ACTION();                         // take proper action
+        if(!MAP_release(MAP_ENC_CW)) ENC_CW_RELEASED(); // take proper action
+        break;
+      case ENC_CCW:                               // counter-clockwise ?
+        if(!MAP_press(MAP_ENC_CCW)) ENC_CCW_ACTION(); // take proper action
         NEO_encoder_ccw();                        // rotate NeoPixels
-        DLY_ms(5);                                // debounce
-        ENC_CCW_RELEASED();                       // take proper action
-      }
-      while(!PIN_read(PIN_ENC_A));                // wait until next detent
-    } 
-    else {
-      if(!isSwitchPressed && !PIN_read(PIN_ENC_SW)) {     // switch previously pressed?
-        ENC_SW_PRESSED();                         // take proper action
-        isSwitchPressed = 1;
-      }
-      else if(isSwitchPressed && PIN_read(PIN_ENC_SW)) {  // switch previously released?
-        ENC_SW_RELEASED();                        // take proper action
-        isSwitchPressed = 0;                      // update switch state
-      }
+        if(!MAP_release(MAP_ENC_CCW)) ENC_CCW_RELEASED(); // take proper action
+        break;
+      case ENC_PUSH_CW:                           // clockwise while pressed ?
+        if(!MAP_press(MAP_ENC_PUSH_CW)) ENC_PUSH_CW_ACTION(); // take proper action
+        NEO_encoder_cw();                         // rotate NeoPixels
+        if(!MAP_release(MAP_ENC_PUSH_CW)) ENC_PUSH_CW_RELEASED(); // take proper action
+        break;
+      case ENC_PUSH_CCW:                          // counter-clockwise while pressed ?
+        if(!MAP_press(MAP_ENC_PUSH_CCW)) ENC_PUSH_CCW_ACTION(); // take proper action
+        NEO_encoder_ccw();                        // rotate NeoPixels
+        if(!MAP_release(MAP_ENC_PUSH_CCW)) ENC_PUSH_CCW_RELEASED(); // take proper action
+        break;
+      case ENC_CLICK:                             // single click ?
+        if(!MAP_type(MAP_ENC_CLICK))   ENC_SW_CLICK();
+        break;
+      case ENC_DOUBLE_CLICK:                      // double click ?
+        if(!MAP_type(MAP_ENC_DOUBLE))  ENC_SW_DOUBLE_CLICK();
+        break;
+      case ENC_TRIPLE_CLICK:                      // triple click ?
+        if(!MAP_type(MAP_ENC_TRIPLE))  ENC_SW_TRIPLE_CLICK();
+        break;
+      case ENC_LONG_PRESSED:                      // long press ?
+        if(!MAP_press(MAP_ENC_LONG))   ENC_SW_LONG_PRESSED();
+        break;
+      case ENC_LONG_RELEASED:                     // released after long press ?
+        if(!MAP_release(MAP_ENC_LONG)) ENC_SW_LONG_RELEASED();
+        break;
+      default:                                    break;
     }
-
-    DLY_ms(1);                                    // debounce
+    HID_flush();                                  // send reports queued before config
+    DIAL_update();                                // send pending dial rotation
+    HID_update();                                 // repeat state reports (idle rate)
+    MK_update();                                  // move pointer for held mouse keys
+    RAW_process();                                // handle Raw HID command
+    if(LED_update()) {                            // host released the pixels?
+      for(i=0; i<SET_KEYS; i++) NEO_clearPixel(i);  // keys get lit on next press
+      NEO_encoder_update();                       // redraw encoder ring
+    }
+    #if USB_MIDI
+    MIDI_flush();                                 // send MIDI events of this scan
+    #endif
+    #if USB_CDC
+    CDC_process();                                // handle debug console
+    #endif
+    STAT_scan();                                  // count loop iterations
+    SET_update();                                 // save changed settings
+
+    DLY_ms(SET_data.scanDelay);                   // debounce
     WDT_reset();                                  // reset watchdog
   }
 }
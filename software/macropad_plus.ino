@@ -12,6 +12,8 @@
 //   - Clock Source:  16 MHz (internal)
 //   - Upload Method: USB
 //   - USB Settings:  USER CODE /w 266B USB RAM
+// - Set USB_MIDI to 0 in src/config.h, the MIDI endpoint buffers don't fit into
+//   266B USB RAM.
 // - Press BOOT button on the board and keep it pressed while connecting it via USB
 //   with your PC.
 // - Click on "Upload" immediatly afterwards.
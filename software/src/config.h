@@ -16,10 +16,62 @@
 #define PIN_ENC_B           P30         // pin connected to rotary encoder B 33
 #define PIN_ENC_SW          P33         // pin connected to rotary encoder switch
 
-// NeoPixel configuration
-#define NEO_COUNT           6           // number of pixels in the string
+// Key scan loop
+#define SCAN_DELAY_ms       1           // main loop delay (key debounce)
+
+// Rotary encoder switch gesture timing
+#define ENC_DEBOUNCE_ms     5           // switch/detent debounce time
+#define ENC_CLICK_GAP_ms    250         // max gap between clicks of a double/triple click
+#define ENC_LONG_PRESS_ms   600         // hold time for a long press
+
+// Range of the timing parameters accepted from the configuration tool
+#define SCAN_DELAY_MIN_ms       1
+#define SCAN_DELAY_MAX_ms       20
+#define ENC_DEBOUNCE_MIN_ms     1
+#define ENC_DEBOUNCE_MAX_ms     50
+#define ENC_CLICK_GAP_MIN_ms    100     // stored in 10ms units
+#define ENC_CLICK_GAP_MAX_ms    1000
+#define ENC_LONG_PRESS_MIN_ms   200     // stored in 10ms units
+#define ENC_LONG_PRESS_MAX_ms   2500
+
+// Default function of the encoder knob: ENC_KNOB_VOLUME, ENC_KNOB_SCROLL or
+// ENC_KNOB_DIAL (see the encoder actions in the main file, mapped keymap slots
+// take precedence)
+#define ENC_KNOB            ENC_KNOB_VOLUME
+#define ENC_SCROLL_STEP     4           // scroll per detent in 1/8 notches (1..127)
+
+// Absolute pointer collection for MOUSE_moveTo() (0: off, 1: on)
+#define MOUSE_ABSOLUTE      1
+
+// Mouse keys (see src/mousekeys.h)
+#define MK_SPEED_MIN        40          // start speed in pixels per second
+#define MK_SPEED_MAX        800         // max speed in pixels per second
+#define MK_ACCEL_ms         1000        // time to reach max speed
+
+// Keyboard layout of the host: KBD_LAYOUT_US, _UK, _DE, _FR or _NORDIC
+// (rerun "make strings" after changing it, the macro strings depend on it)
+#define KBD_LAYOUT          KBD_LAYOUT_US
+
+// Default Unicode input method of the host: UNI_LINUX, UNI_WINDOWS or UNI_MACOS
+// (can be changed at runtime, see src/unicode.h)
+#define UNI_MODE            UNI_LINUX
+
+// Runtime settings
+#define SET_SAVE_DELAY_ms   1000        // delay between last change and DataFlash write
+
+// NeoPixel configuration: 6 keys, 12 ring pixels and an optional external strip
+// connected to DATA-OUT of the last ring pixel, which is only lit by host-driven
+// frames (each pixel needs 3 bytes of XRAM, see src/neo.h for long chains)
+#define NEO_EXT_COUNT       0           // number of pixels of the external strip
+#define NEO_COUNT           (18 + NEO_EXT_COUNT)  // number of pixels in the string
+#define NEO_SEGMENT         0           // pixels sent with interrupts disabled (0: all,
+                                        // segments need pixels with 280us latch time)
 #define NEO_GRB                         // type of pixel: NEO_GRB or NEO_RGB
 
+// Host-driven NeoPixel frames via Raw HID (see src/ledstream.h)
+#define LED_FRAME_ms        20          // min time between shown frames (50 FPS)
+#define LED_TIMEOUT_ms      3000        // back to local effects without frames
+
 // USB device descriptor
 #define USB_VENDOR_ID       0x1189      // VID
 #define USB_PRODUCT_ID      0x8890      // PID
@@ -28,6 +80,18 @@
 // USB configuration descriptor
 #define USB_MAX_POWER_mA    150         // max power in mA 
 
+// USB MIDI interface for keys and encoder (0: off, 1: on, needs XRAM_LOC 0x0160)
+#define USB_MIDI            1
+#define MIDI_CHANNEL        1           // MIDI channel of sent events (1..16)
+
+// USB CDC-ACM debug console (0: off, 1: on, needs USB_MIDI 0 and XRAM_LOC 0x01A0)
+#define USB_CDC             0
+
+// WebUSB/WinUSB vendor interface for driverless access by the configuration tool
+// (0: off, 1: on) and WebUSB landing page (https:// is added)
+#define USB_WEBUSB          1
+#define WEBUSB_URL          "github.com/wagiminator/CH552-MacroPad-plus"
+
 // USB descriptor strings
 #define MANUFACTURER_STR    'w','a','g','i','m','i','n','a','t','o','r'
 #define PRODUCT_STR         'M','a','c','r','o','P','a','d'
@@ -0,0 +1,99 @@
+// ===================================================================================
+// Rotary Encoder with Switch Gesture Recognition for CH551, CH552 and CH554
+// ===================================================================================
+//
+// Non-blocking rotary encoder decoder. Detents are detected on the falling edge of
+// encoder output A. The encoder switch is debounced and fed into a gesture
+// recognizer, which distinguishes single/double/triple clicks, long presses and
+// rotations while the switch is pressed.
+
+#include "encoder.h"
+#include "timer.h"
+#include "settings.h"
+
+// Gesture recognizer states
+#define ENC_ST_IDLE         0       // switch released, no gesture in progress
+#define ENC_ST_DOWN         1       // switch pressed, waiting for release
+#define ENC_ST_UP           2       // switch released, waiting for next click
+#define ENC_ST_LONG         3       // switch held after long press event
+#define ENC_ST_TURN         4       // encoder rotated while switch pressed
+
+__bit    ENC_lastA;                 // last state of encoder output A
+__bit    ENC_lastSW;                // last debounced switch state (1 = pressed)
+uint8_t  ENC_state;                 // gesture recognizer state
+uint8_t  ENC_clicks;                // number of clicks in current gesture
+uint16_t ENC_timeA;                 // time of last detent
+uint16_t ENC_timeSW;                // time of last switch state change
+
+// ===================================================================================
+// Init Encoder State
+// ===================================================================================
+void ENC_init(void) {
+  ENC_lastA  = PIN_read(PIN_ENC_A);
+  ENC_lastSW = 0;
+  ENC_state  = ENC_ST_IDLE;
+  ENC_timeA  = ENC_timeSW = TIM_millis();
+}
+
+// ===================================================================================
+// Process Encoder and Return Next Event
+// ===================================================================================
+uint8_t ENC_read(void) {
+  uint16_t now = TIM_millis();
+  uint16_t elapsed;
+
+  // Rotation: falling edge of A, direction by B
+  if(PIN_read(PIN_ENC_A) != ENC_lastA) {
+    if((uint16_t)(now - ENC_timeA) >= SET_data.encDebounce) {
+      ENC_lastA = !ENC_lastA;
+      ENC_timeA = now;
+      if(!ENC_lastA) {
+        if(ENC_lastSW) {                          // turned while pressed?
+          if(ENC_state != ENC_ST_LONG) ENC_state = ENC_ST_TURN;
+          return(PIN_read(PIN_ENC_B) ? ENC_PUSH_CW : ENC_PUSH_CCW);
+        }
+        return(PIN_read(PIN_ENC_B) ? ENC_CW : ENC_CCW);
+      }
+    }
+  }
+
+  // Switch: debounced edge detection
+  elapsed = now - ENC_timeSW;
+  if(ENC_isPressed() != ENC_lastSW && elapsed >= SET_data.encDebounce) {
+    ENC_lastSW = !ENC_lastSW;
+    ENC_timeSW = now;
+    elapsed    = 0;
+    if(ENC_lastSW) {                              // switch was pressed?
+      if(ENC_state == ENC_ST_IDLE) ENC_clicks = 0;
+      ENC_state = ENC_ST_DOWN;
+    }
+    else {                                        // switch was released?
+      switch(ENC_state) {
+        case ENC_ST_DOWN:
+          if(++ENC_clicks < 3) {
+            ENC_state = ENC_ST_UP;                // wait for another click
+            break;
+          }
+          ENC_state = ENC_ST_IDLE;
+          return ENC_TRIPLE_CLICK;
+        case ENC_ST_LONG:
+          ENC_state = ENC_ST_IDLE;
+          return ENC_LONG_RELEASED;
+        default:
+          ENC_state = ENC_ST_IDLE;                // end of pushed rotation
+          break;
+      }
+    }
+  }
+
+  // Time-based transitions
+  if(ENC_state == ENC_ST_DOWN && elapsed >= (uint16_t)SET_data.longPress * 10) {
+    ENC_state = ENC_ST_LONG;
+    return ENC_LONG_PRESSED;
+  }
+  if(ENC_state == ENC_ST_UP && elapsed >= (uint16_t)SET_data.clickGap * 10) {
+    ENC_state = ENC_ST_IDLE;
+    return(ENC_clicks == 1 ? ENC_CLICK : ENC_DOUBLE_CLICK);
+  }
+  return ENC_NONE;
+}
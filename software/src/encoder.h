@@ -0,0 +1,44 @@
+// ===================================================================================
+// Rotary Encoder with Switch Gesture Recognition for CH551, CH552 and CH554
+// ===================================================================================
+//
+// Non-blocking rotary encoder decoder. Detents are detected on the falling edge of
+// encoder output A. The encoder switch is debounced and fed into a gesture
+// recognizer, which distinguishes single/double/triple clicks, long presses and
+// rotations while the switch is pressed. All timing is based on the system tick,
+// so ENC_read() must be called frequently from the main loop. The timing parameters
+// are taken from the runtime settings (SET_data), their defaults from config.h.
+//
+// The following must be defined in config.h:
+// PIN_ENC_A            - pin connected to rotary encoder A
+// PIN_ENC_B            - pin connected to rotary encoder B
+// PIN_ENC_SW           - pin connected to rotary encoder switch
+// ENC_DEBOUNCE_ms      - default switch/detent debounce time in ms
+// ENC_CLICK_GAP_ms     - default max time between two clicks of a multi-click in ms
+// ENC_LONG_PRESS_ms    - default time the switch must be held for a long press in ms
+
+#pragma once
+#include <stdint.h>
+#include "gpio.h"
+#include "config.h"
+
+// Encoder events
+#define ENC_NONE            0       // nothing happened
+#define ENC_CW              1       // rotated clockwise
+#define ENC_CCW             2       // rotated counter-clockwise
+#define ENC_PUSH_CW         3       // rotated clockwise while switch pressed
+#define ENC_PUSH_CCW        4       // rotated counter-clockwise while switch pressed
+#define ENC_CLICK           5       // switch single click
+#define ENC_DOUBLE_CLICK    6       // switch double click
+#define ENC_TRIPLE_CLICK    7       // switch triple click
+#define ENC_LONG_PRESSED    8       // switch held down for long press time
+#define ENC_LONG_RELEASED   9       // switch released after long press
+
+// Default knob functions of the main file (ENC_KNOB in config.h)
+#define ENC_KNOB_VOLUME     0       // volume, media keys while pressed
+#define ENC_KNOB_SCROLL     1       // high-resolution wheel, pan while pressed
+#define ENC_KNOB_DIAL       2       // radial controller (Surface Dial)
+
+void ENC_init(void);                // init encoder state (needs system tick)
+uint8_t ENC_read(void);             // process encoder, return next event
+#define ENC_isPressed()     (!PIN_read(PIN_ENC_SW))
@@ -0,0 +1,39 @@
+// ===================================================================================
+// DataFlash Functions for CH551, CH552 and CH554
+// ===================================================================================
+
+#include "ch554.h"
+#include "flash.h"
+
+// ===================================================================================
+// Read Byte from DataFlash
+// ===================================================================================
+uint8_t FLASH_read(uint8_t addr) {
+  ROM_ADDR_H = DATA_FLASH_ADDR >> 8;
+  ROM_ADDR_L = addr << 1;                       // DataFlash uses even addresses only
+  ROM_CTRL   = ROM_CMD_READ;
+  return ROM_DATA_L;
+}
+
+// ===================================================================================
+// Write Byte to DataFlash
+// ===================================================================================
+void FLASH_write(uint8_t addr, uint8_t data) {
+  __bit ea = EA;
+  EA = 0;                                       // safe mode must not be interrupted
+  SAFE_MOD    = 0x55;
+  SAFE_MOD    = 0xAA;                           // enter safe mode
+  GLOBAL_CFG |= bDATA_WE;                       // enable DataFlash write
+  SAFE_MOD    = 0x00;                           // terminate safe mode
+  EA = ea;                                      // the write itself may be interrupted
+  ROM_ADDR_H  = DATA_FLASH_ADDR >> 8;
+  ROM_ADDR_L  = addr << 1;
+  ROM_DATA_L  = data;
+  if(ROM_STATUS & bROM_ADDR_OK) ROM_CTRL = ROM_CMD_WRITE;   // write byte
+  EA = 0;
+  SAFE_MOD    = 0x55;
+  SAFE_MOD    = 0xAA;                           // enter safe mode
+  GLOBAL_CFG &= ~bDATA_WE;                      // disable DataFlash write
+  SAFE_MOD    = 0x00;                           // terminate safe mode
+  EA = ea;
+}
@@ -0,0 +1,17 @@
+// ===================================================================================
+// DataFlash Functions for CH551, CH552 and CH554
+// ===================================================================================
+//
+// Byte-wise access to the 128-byte DataFlash (EEPROM replacement). Each byte is
+// erased automatically when written. Writing a byte takes a few milliseconds and
+// should only be done when necessary, the number of erase cycles is limited.
+// Interrupts are only disabled for the safe mode sequences, not for the write
+// itself, so the ROM_ADDR/ROM_DATA registers must not be used in interrupts.
+
+#pragma once
+#include <stdint.h>
+
+#define FLASH_SIZE  128                         // DataFlash size in bytes
+
+uint8_t FLASH_read(uint8_t addr);               // read byte from DataFlash
+void FLASH_write(uint8_t addr, uint8_t data);   // write byte to DataFlash
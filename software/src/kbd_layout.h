@@ -0,0 +1,39 @@
+// ===================================================================================
+// Keyboard Layout Tables (generated by tools/kbdlayout.py, do not edit)
+// ===================================================================================
+//
+// KBD_map[c]:    keycode of ASCII character c, bit 7 set if shift is needed
+// KBD_mapExt[]:  two bits per character, KBD_EXT_ALTGR and KBD_EXT_DEAD
+//
+// The layout is selected with KBD_LAYOUT in config.h.
+
+#pragma once
+#include <stdint.h>
+#include "config.h"
+
+#define KBD_LAYOUT_US       0
+#define KBD_LAYOUT_UK       1
+#define KBD_LAYOUT_DE       2
+#define KBD_LAYOUT_FR       3
+#define KBD_LAYOUT_NORDIC   4
+
+#define KBD_EXT_ALTGR       0x01     // needs AltGr (right alt)
+#define KBD_EXT_DEAD        0x02     // dead key, must be followed by space
+#define KBD_getExt(c)       ((KBD_mapExt[(c) >> 2] >> (((c) & 3) << 1)) & 3)
+
+#if   KBD_LAYOUT == KBD_LAYOUT_US
+  #define KBD_COUNTRY_CODE  33
+#elif KBD_LAYOUT == KBD_LAYOUT_UK
+  #define KBD_COUNTRY_CODE  32
+#elif KBD_LAYOUT == KBD_LAYOUT_DE
+  #define KBD_COUNTRY_CODE  9
+#elif KBD_LAYOUT == KBD_LAYOUT_FR
+  #define KBD_COUNTRY_CODE  8
+#elif KBD_LAYOUT == KBD_LAYOUT_NORDIC
+  #define KBD_COUNTRY_CODE  26
+#else
+  #error Unknown KBD_LAYOUT in config.h
+#endif
+
+extern __code uint8_t KBD_map[128];
+extern __code uint8_t KBD_mapExt[32];
@@ -0,0 +1,24 @@
+// ===================================================================================
+// Keyboard Macro Strings (generated by tools/kbdstr.py from kbd_strings.txt, do not edit)
+// ===================================================================================
+
+#include "kbd_strings.h"
+
+__code uint8_t KBD_strings[] = {
+  // fragment 0 (offset 0)
+  0xf3, 0x02, 0x16, 0x17, 0x08, 0x09, 0x04, 0x11, 0x2c, 0xf3, 0x02, 0x1a,
+  0x04, 0x0a, 0x11, 0x08, 0x15, 0x28, 0x00,
+  // STR_HELLO (offset 19)
+  0xf3, 0x02, 0x0b, 0x08, 0x0f, 0x0f, 0x12, 0x2c, 0xf3, 0x02, 0x1a, 0x12,
+  0x15, 0x0f, 0x07, 0xf3, 0x02, 0x1e, 0x28, 0x00,
+  // STR_SIGNATURE (offset 39)
+  0xf3, 0x02, 0x05, 0x08, 0x16, 0x17, 0x2c, 0x15, 0x08, 0x0a, 0x04, 0x15,
+  0x07, 0x16, 0x36, 0x28, 0xf2, 0x00, 0x00, 0x00,
+  // STR_RULER (offset 59)
+  0xf1, 0x28, 0x2d, 0x28, 0x00,
+  // STR_ADDRESS (offset 64)
+  0xf2, 0x00, 0x00, 0x0b, 0x17, 0x17, 0x13, 0x16, 0xf3, 0x02, 0x33, 0x38,
+  0x38, 0x0a, 0x0c, 0x17, 0x0b, 0x18, 0x05, 0x37, 0x06, 0x12, 0x10, 0x38,
+  0x1a, 0x04, 0x0a, 0x0c, 0x10, 0x0c, 0x11, 0x04, 0x17, 0x12, 0x15, 0x28,
+  0x00,
+};
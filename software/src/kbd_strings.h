@@ -0,0 +1,15 @@
+// ===================================================================================
+// Keyboard Macro Strings (generated by tools/kbdstr.py from kbd_strings.txt, do not edit)
+// ===================================================================================
+//
+// Type a string with KBD_play(NAME).
+
+#pragma once
+#include <stdint.h>
+
+extern __code uint8_t KBD_strings[];
+
+#define STR_HELLO            (KBD_strings + 19)   // "Hello World!\n"
+#define STR_SIGNATURE        (KBD_strings + 39)   // "Best regards,\nStefan Wagner\n"
+#define STR_RULER            (KBD_strings + 59)   // "----------------------------------------\n"
+#define STR_ADDRESS          (KBD_strings + 64)   // "Stefan Wagner\nhttps://github.com/wagiminator\n"
@@ -0,0 +1,73 @@
+// ===================================================================================
+// Runtime Keymap for CH551, CH552 and CH554
+// ===================================================================================
+
+#include "keymap.h"
+#include "usb_composite.h"
+#include "unicode.h"
+#include "mousekeys.h"
+#include "usb_midi.h"
+
+// ===================================================================================
+// Start Action of Keymap Slot
+// ===================================================================================
+uint8_t MAP_press(uint8_t slot) {
+  uint8_t i;
+  __xdata MAP_ENTRY* entry = &SET_data.keymap[slot];
+  switch(entry->type) {
+    case MAP_DEFAULT:   return 0;
+    case MAP_KEY:
+      for(i=0; i<8; i++)                          // press modifiers first
+        if(entry->param & (1 << i)) KBD_press(KBD_KEY_LEFT_CTRL + i);
+      KBD_press(entry->code);
+      break;
+    case MAP_CONSUMER:  CON_press(entry->code | (uint16_t)entry->param << 8); break;
+    case MAP_MOUSE:     MOUSE_press(entry->code);         break;
+    case MAP_WHEEL:     MOUSE_wheel((int8_t)entry->code); break;
+    case MAP_JOY:       JOY_press(entry->code | (uint16_t)entry->param << 8); break;
+    case MAP_JOYDIAL:   JOY_dial((int8_t)entry->code);    break;
+    case MAP_JOYHAT:    JOY_hat(entry->code);             break;
+    case MAP_SYSTEM:    SYS_press(entry->code);           break;
+    case MAP_MOUSEKEY:  MK_press(entry->code);            break;
+    #if USB_MIDI
+    case MAP_MIDI_NOTE: MIDI_noteOn(entry->code, entry->param);       break;
+    case MAP_MIDI_CC:   MIDI_cc(entry->code, entry->param);           break;
+    case MAP_MIDI_REL:  MIDI_ccRel(entry->code, (int8_t)entry->param); break;
+    #endif
+    case MAP_UNICODE:   UNI_type(entry->code | (uint16_t)entry->param << 8); break;
+    case MAP_UNIMODE:
+      if(entry->code == 0xFF) UNI_nextMode();
+      else UNI_setMode(entry->code);
+      break;
+    default:                                              break;
+  }
+  return 1;
+}
+
+// ===================================================================================
+// End Action of Keymap Slot
+// ===================================================================================
+uint8_t MAP_release(uint8_t slot) {
+  uint8_t i;
+  __xdata MAP_ENTRY* entry = &SET_data.keymap[slot];
+  switch(entry->type) {
+    case MAP_DEFAULT:   return 0;
+    case MAP_KEY:
+      KBD_release(entry->code);
+      for(i=0; i<8; i++)
+        if(entry->param & (1 << i)) KBD_release(KBD_KEY_LEFT_CTRL + i);
+      break;
+    case MAP_CONSUMER:  CON_release(entry->code | (uint16_t)entry->param << 8); break;
+    case MAP_MOUSE:     MOUSE_release(entry->code);       break;
+    case MAP_JOY:       JOY_release(entry->code | (uint16_t)entry->param << 8); break;
+    case MAP_JOYHAT:    JOY_hat(JOY_HAT_CENTER);          break;
+    case MAP_SYSTEM:    SYS_release();                    break;
+    case MAP_MOUSEKEY:  MK_release(entry->code);          break;
+    #if USB_MIDI
+    case MAP_MIDI_NOTE: MIDI_noteOff(entry->code);        break;
+    case MAP_MIDI_CC:   MIDI_cc(entry->code, 0);          break;
+    #endif
+    default:                                              break;
+  }
+  return 1;
+}
@@ -0,0 +1,34 @@
+// ===================================================================================
+// Runtime Keymap for CH551, CH552 and CH554
+// ===================================================================================
+//
+// Each key and encoder event has a keymap slot in the runtime settings. A slot of
+// type MAP_DEFAULT keeps the compiled-in macro function of the main file, all other
+// types replace it by a simple action which can be changed at runtime.
+
+#pragma once
+#include <stdint.h>
+#include "settings.h"
+
+// Action types
+#define MAP_DEFAULT         0       // compiled-in macro function
+#define MAP_NONE            1       // do nothing
+#define MAP_KEY             2       // keyboard key (code), modifiers (param)
+#define MAP_CONSUMER        3       // consumer key (code, param: high byte)
+#define MAP_MOUSE           4       // mouse buttons (code)
+#define MAP_WHEEL           5       // mouse wheel notches (code, signed)
+#define MAP_JOY             6       // joystick buttons (code, param: buttons 9..16)
+#define MAP_UNICODE         7       // type Unicode character (code, param: high byte)
+#define MAP_UNIMODE         8       // select Unicode input method (code, 0xFF: next)
+#define MAP_SYSTEM          9       // system control key (code), wakes up the host
+#define MAP_MOUSEKEY        10      // mouse keys movement (code: MK_UP/DOWN/LEFT/RIGHT)
+#define MAP_JOYDIAL         11      // turn joystick dial axis (code, signed steps)
+#define MAP_JOYHAT          12      // joystick hat switch direction (code)
+#define MAP_MIDI_NOTE       13      // MIDI note (code), velocity (param)
+#define MAP_MIDI_CC         14      // MIDI control change (code), value (param)
+#define MAP_MIDI_REL        15      // relative MIDI CC (code, param: signed steps)
+
+uint8_t MAP_press(uint8_t slot);    // start action, return 0 if not mapped
+uint8_t MAP_release(uint8_t slot);  // end action, return 0 if not mapped
+#define MAP_isSet(slot)     (SET_data.keymap[slot].type != MAP_DEFAULT)
+#define MAP_type(slot)      (MAP_press(slot) && MAP_release(slot))
@@ -0,0 +1,64 @@
+// ===================================================================================
+// Host-Driven NeoPixel Frames for CH551, CH552 and CH554
+// ===================================================================================
+
+#include "ledstream.h"
+#include "neo.h"
+#include "timer.h"
+
+__bit LED_streaming = 0;                    // host controls the pixels
+__bit LED_pending = 0;                      // complete frame waits to be shown
+__bit LED_released = 0;                     // host gave control back
+uint8_t LED_seq;                            // sequence number of current frame
+uint8_t LED_shownSeq;                       // sequence number of last shown frame
+uint8_t LED_gaugeLevel;                     // level of encoder ring gauge
+uint16_t LED_lastFrame;                     // time of last frame command
+uint16_t LED_lastShow;                      // time of last pixel update
+
+// ===================================================================================
+// Write Pixels of Frame Command [seq] [first(2)] [count] [flags] [r g b ...]
+// ===================================================================================
+uint8_t LED_frame(__xdata uint8_t* cmd) {
+  uint8_t i;
+  __xdata uint8_t* src = cmd + 5;
+  __xdata uint8_t* dst = NEO_buffer + 3 * *(__xdata uint16_t*)(cmd + 1);
+
+  if(LED_streaming && (int8_t)(cmd[0] - LED_seq) < 0) return 0; // stale frame
+  LED_seq       = cmd[0];
+  LED_lastFrame = TIM_millis();
+  if(cmd[4] & LED_FLAG_RELEASE) {
+    if(LED_streaming) LED_released = 1;
+    return 1;
+  }
+  LED_streaming = 1;
+  for(i=cmd[3]; i; i--, src+=3) {           // straight into the pixel buffer
+    #if defined (NEO_GRB)
+      *dst++ = src[1]; *dst++ = src[0]; *dst++ = src[2];
+    #else
+      *dst++ = src[0]; *dst++ = src[1]; *dst++ = src[2];
+    #endif
+  }
+  if(cmd[4] & LED_FLAG_SHOW) LED_pending = 1;
+  else LED_pending = 0;                     // buffer holds a partial frame now
+  return 1;
+}
+
+// ===================================================================================
+// Show Pending Frame (rate-limited) and Check for End of Streaming
+// ===================================================================================
+uint8_t LED_update(void) {
+  if(!LED_streaming) return 0;
+  if(LED_released || (uint16_t)(TIM_millis() - LED_lastFrame) >= LED_TIMEOUT_ms) {
+    LED_streaming = 0;
+    LED_released  = 0;
+    LED_pending   = 0;
+    return 1;                               // main loop redraws local effects
+  }
+  if(LED_pending && (uint16_t)(TIM_millis() - LED_lastShow) >= LED_FRAME_ms) {
+    LED_lastShow = TIM_millis();
+    LED_pending  = 0;
+    LED_shownSeq = LED_seq;
+    NEO_update();
+  }
+  return 0;
+}
@@ -0,0 +1,49 @@
+// ===================================================================================
+// Host-Driven NeoPixel Frames for CH551, CH552 and CH554
+// ===================================================================================
+//
+// The host can take over the NeoPixels including an external strip (NEO_EXT_COUNT),
+// e.g. for build status or on-air indicators, by sending frames via the Raw HID
+// command RAW_CMD_LED_FRAME (see usb_rawhid.h). Each command writes a range of
+// pixels as R,G,B triplets directly from the command packet into NEO_buffer, so a
+// frame of more than 19 pixels is split into several commands with the same 8-bit
+// sequence number. Commands with an older sequence
+// number than the current frame are rejected, the host may skip numbers.
+//
+// LED_FLAG_SHOW in the last command of a frame marks the frame as complete. It is
+// written to the pixels by LED_update() (called from the main loop) at most every
+// LED_FRAME_ms, frames arriving faster are coalesced (the latest one is shown), so
+// the scan loop spends at most one pixel update per LED_FRAME_ms on streaming.
+//
+// While the host is in control, the local key and encoder ring effects are
+// suspended (LED_streaming is set). Control returns to the firmware with
+// LED_FLAG_RELEASE or if no frame command arrives for LED_TIMEOUT_ms, then
+// LED_update() returns 1 once and the main loop redraws its local effects.
+//
+// In NEO_RING_GAUGE mode (SET_data.ringMode) the encoder ring shows LED_gaugeLevel
+// (0..255) as a bar with an anti-aliased tip (16 brightness steps per pixel). The
+// level is changed by the encoder detents and can be set by the host via the Raw
+// HID command RAW_CMD_GAUGE, so it follows e.g. the actual volume of the host. The
+// main loop only redraws the ring when the quantised level changes.
+//
+// The following must be defined in config.h:
+// LED_FRAME_ms         - min time between two streamed frames (e.g. 20 for 50 FPS)
+// LED_TIMEOUT_ms       - return to local effects after this time without frames
+
+#pragma once
+#include <stdint.h>
+
+// Encoder ring modes (SET_data.ringMode)
+#define NEO_RING_RAINBOW    0       // rainbow rotating with each detent
+#define NEO_RING_GAUGE      1       // bar showing LED_gaugeLevel
+
+// Frame command flags
+#define LED_FLAG_SHOW       0x01    // frame complete, show it
+#define LED_FLAG_RELEASE    0x02    // return pixels to local effects
+
+extern __bit LED_streaming;         // host controls the pixels
+extern uint8_t LED_shownSeq;        // sequence number of last shown frame
+extern uint8_t LED_gaugeLevel;      // level of encoder ring gauge (0..255)
+
+uint8_t LED_frame(__xdata uint8_t* cmd);  // write pixels of frame command, 0: stale
+uint8_t LED_update(void);                 // show frame (main loop), 1: back to local
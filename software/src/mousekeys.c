@@ -0,0 +1,73 @@
+// ===================================================================================
+// Mouse Keys Motion Engine for CH551, CH552 and CH554
+// ===================================================================================
+
+#include "mousekeys.h"
+#include "config.h"
+#include "timer.h"
+#include "usb_composite.h"
+
+// Speeds in pixels per ms, 8.8 fixed point
+#define MK_V_MIN        ((uint16_t)((MK_SPEED_MIN * 256UL) / 1000))
+#define MK_V_MAX        ((uint16_t)((MK_SPEED_MAX * 256UL) / 1000))
+#define MK_DT_MAX       50                  // max time step in ms (after long blocking)
+#define MK_DIAGONAL     181                 // 1/sqrt(2) in 0.8 fixed point
+
+uint8_t  MK_dirs = 0;                       // directions currently held
+uint16_t MK_start;                          // start of acceleration
+uint16_t MK_last;                           // time of last tick
+int16_t  MK_accX, MK_accY;                  // sub-pixel position (8.8 fixed point)
+
+// ===================================================================================
+// Start and Stop Moving
+// ===================================================================================
+void MK_press(uint8_t dirs) {
+  if(!MK_dirs) {                            // start of a new movement?
+    MK_start = MK_last = TIM_millis();
+    MK_accX  = MK_accY = 0;
+  }
+  MK_dirs |= dirs;
+}
+
+void MK_release(uint8_t dirs) {
+  MK_dirs &= ~dirs;
+}
+
+// ===================================================================================
+// Move Pointer according to elapsed Time
+// ===================================================================================
+void MK_update(void) {
+  uint16_t now, held, step;
+  uint8_t  dt;
+  int8_t   dx, dy;
+
+  if(!MK_dirs || !USB_configured() || HID_EP1_writeBusyFlag) return;
+  now = TIM_millis();
+  if(now == MK_last) return;                // one report per frame
+  dt = (uint16_t)(now - MK_last) > MK_DT_MAX ? MK_DT_MAX : now - MK_last;
+  MK_last = now;
+
+  // Speed ramp
+  held = now - MK_start;
+  if(held >= MK_ACCEL_ms) {
+    MK_start = now - MK_ACCEL_ms;           // keep it there (no overflow)
+    step = MK_V_MAX;
+  }
+  else step = MK_V_MIN + (uint16_t)((uint32_t)(MK_V_MAX - MK_V_MIN) * held / MK_ACCEL_ms);
+  step *= dt;                               // distance of this tick
+
+  // Diagonal normalisation
+  if((MK_dirs & (MK_UP | MK_DOWN)) && (MK_dirs & (MK_LEFT | MK_RIGHT)))
+    step = ((uint32_t)step * MK_DIAGONAL) >> 8;
+
+  // Accumulate sub-pixel position and send whole pixels
+  if(MK_dirs & MK_LEFT)  MK_accX -= step;
+  if(MK_dirs & MK_RIGHT) MK_accX += step;
+  if(MK_dirs & MK_UP)    MK_accY -= step;
+  if(MK_dirs & MK_DOWN)  MK_accY += step;
+  dx = MK_accX >> 8;                        // whole pixels (floor)
+  dy = MK_accY >> 8;
+  MK_accX -= (int16_t)dx << 8;              // keep fractions
+  MK_accY -= (int16_t)dy << 8;
+  if(dx || dy) MOUSE_move(dx, dy);
+}
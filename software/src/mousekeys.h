@@ -0,0 +1,29 @@
+// ===================================================================================
+// Mouse Keys Motion Engine for CH551, CH552 and CH554
+// ===================================================================================
+//
+// Moves the mouse pointer continuously as long as direction keys are held down. The
+// speed ramps up linearly from MK_SPEED_MIN to MK_SPEED_MAX within MK_ACCEL_ms,
+// diagonal movements are scaled by 1/sqrt(2). The position is accumulated in 8.8
+// fixed point, so slow speeds still move smoothly by fractions of a pixel per tick.
+//
+// MK_update() must be called in the main loop. It is timed by TIM_millis() and
+// sends at most one mouse report per USB frame (1ms) and only if EP1 is free.
+//
+// The following must be defined in config.h:
+// MK_SPEED_MIN         - start speed in pixels per second
+// MK_SPEED_MAX         - max speed in pixels per second (up to 2000)
+// MK_ACCEL_ms          - time to reach max speed
+
+#pragma once
+#include <stdint.h>
+
+// Directions
+#define MK_UP               0x01
+#define MK_DOWN             0x02
+#define MK_LEFT             0x04
+#define MK_RIGHT            0x08
+
+void MK_press(uint8_t dirs);                // start moving in direction(s)
+void MK_release(uint8_t dirs);              // stop moving in direction(s)
+void MK_update(void);                       // move pointer, call in main loop
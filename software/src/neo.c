@@ -99,14 +99,56 @@ void NEO_sendByte(uint8_t data) {
   __endasm;
 }
 
+// ===================================================================================
+// Segmented Transmission
+// ===================================================================================
+// Between two segments, interrupts are enabled for one instruction only, so at most
+// one pending interrupt is serviced (an instruction that writes EA and a RETI are
+// always followed by one more instruction before an interrupt is taken). With
+// NEO_SEGMENT 0 interrupts stay disabled for the whole chain.
+#if NEO_SEGMENT < 0 || NEO_SEGMENT > 85
+  #error NEO_SEGMENT must be 0..85 pixels!
+#endif
+
+#if NEO_SEGMENT
+#define NEO_SEG_BYTES (3 * NEO_SEGMENT)     // bytes per segment
+#define NEO_window()  EA = 1; __asm__("nop"); EA = 0
+#define NEO_segment() if(!--seg) { NEO_window(); seg = NEO_SEG_BYTES; }
+#else
+#define NEO_segment()
+#endif
+
 // ===================================================================================
 // Write Buffer to Pixels
 // ===================================================================================
 void NEO_update(void) {
-  uint8_t i;
+  uint16_t i;
+  #if NEO_SEGMENT
+  uint8_t  seg = NEO_SEG_BYTES;
+  #endif
   ptr = NEO_buffer;
   EA = 0;
-  for(i=3*NEO_COUNT; i; i--) NEO_sendByte(*ptr++);
+  for(i=3*NEO_COUNT; i; i--) {
+    NEO_sendByte(*ptr++);
+    NEO_segment();                          // end of segment: service one interrupt
+  }
+  EA = 1;
+  NEO_latch();
+}
+
+// ===================================================================================
+// Write Value to all Pixels without changing the Buffer (restore with NEO_update)
+// ===================================================================================
+void NEO_fill(uint8_t value) {
+  uint16_t i;
+  #if NEO_SEGMENT
+  uint8_t  seg = NEO_SEG_BYTES;
+  #endif
+  EA = 0;
+  for(i=3*NEO_COUNT; i; i--) {
+    NEO_sendByte(value);
+    NEO_segment();                          // end of segment: service one interrupt
+  }
   EA = 1;
   NEO_latch();
 }
@@ -115,7 +157,7 @@ void NEO_update(void) {
 // Clear all Pixels
 // ===================================================================================
 void NEO_clearAll(void) {
-  uint8_t i;
+  uint16_t i;
   ptr = NEO_buffer;
   for(i=3*NEO_COUNT; i; i--) *ptr++ = 0;
   NEO_update();
@@ -124,7 +166,7 @@ void NEO_clearAll(void) {
 // ===================================================================================
 // Write Color to a Single Pixel in Buffer
 // ===================================================================================
-void NEO_writeColor(uint8_t pixel, uint8_t r, uint8_t g, uint8_t b) {
+void NEO_writeColor(NEO_INDEX pixel, uint8_t r, uint8_t g, uint8_t b) {
   ptr = NEO_buffer + (3 * pixel);
   #if defined (NEO_GRB)
     *ptr++ = g; *ptr++ = r; *ptr = b;
@@ -138,7 +180,7 @@ void NEO_writeColor(uint8_t pixel, uint8_t r, uint8_t g, uint8_t b) {
 // ===================================================================================
 // Write Hue Value (0..191) and Brightness (0..2) to a Single Pixel in Buffer
 // ===================================================================================
-void NEO_writeHue(uint8_t pixel, uint8_t hue, uint8_t bright) {
+void NEO_writeHue(NEO_INDEX pixel, uint8_t hue, uint8_t bright) {
   uint8_t phase = hue >> 6;
   uint8_t step  = (hue & 63) << bright;
   uint8_t nstep = (63 << bright) - step;
@@ -153,6 +195,15 @@ void NEO_writeHue(uint8_t pixel, uint8_t hue, uint8_t bright) {
 // ===================================================================================
 // Clear Single Pixel in Buffer
 // ===================================================================================
-void NEO_clearPixel(uint8_t pixel) {
+void NEO_clearPixel(NEO_INDEX pixel) {
   NEO_writeColor(pixel, 0, 0, 0);
 }
+
+// ===================================================================================
+// Scale Brightness of Single Pixel in Buffer by level/256
+// ===================================================================================
+void NEO_dimPixel(NEO_INDEX pixel, uint8_t level) {
+  uint8_t i;
+  ptr = NEO_buffer + (3 * pixel);
+  for(i=3; i; i--, ptr++) *ptr = ((uint16_t)*ptr * level) >> 8;
+}
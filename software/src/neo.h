@@ -11,6 +11,17 @@
 // NEO_COUNT - total number of pixels
 // System clock frequency must be at least 6 MHz.
 //
+// With NEO_SEGMENT 0 all pixels are sent with interrupts disabled, about 30us per
+// pixel. Otherwise they are sent in segments of NEO_SEGMENT pixels, and between two
+// segments interrupts are enabled for exactly one instruction, so at most one
+// pending interrupt is serviced. This keeps the system tick and USB alive with long
+// chains, but the interrupt handler must not run longer than the latch time of the
+// pixels. USB handlers copying a 64-byte packet to EP0 (descriptors, WebUSB
+// responses) take about 100us at 16MHz, so segments need pixels with a latch time
+// of 280us (WS2812B-V5, WS2813, ...), not older ones with 50us. Segments of 8 pixels
+// block the interrupts for about 250us. Each pixel needs 3 bytes of XRAM, chains
+// that don't fit are reported by the linker (--xram-size in the makefile).
+//
 // Further information:     https://github.com/wagiminator/ATtiny13-NeoController
 // 2023 by Stefan Wagner:   https://github.com/wagiminator
 
@@ -20,12 +31,28 @@
 #include "delay.h"
 #include "config.h"
 
+#ifndef NEO_SEGMENT
+#define NEO_SEGMENT 0                                                 // pixels per segment
+#endif
+
+// Pixel index (16-bit only for chains of more than 255 pixels)
+#if NEO_COUNT > 255
+typedef uint16_t NEO_INDEX;
+#else
+typedef uint8_t  NEO_INDEX;
+#endif
+
 #define NEO_init()  PIN_low(PIN_NEO);PIN_output(PIN_NEO)              // init NeoPixels
 #define NEO_latch() DLY_us(281)                                       // latch colors
+#define NEO_blank() NEO_fill(0)                                       // switch off pixels, keep buffer
+
+extern __xdata uint8_t NEO_buffer[3 * NEO_COUNT];                     // pixel buffer
 
 void NEO_sendByte(uint8_t data);                                      // send a single byte to the pixels
 void NEO_clearAll(void);                                              // clear all pixels
 void NEO_update(void);                                                // write buffer to pixels
-void NEO_writeColor(uint8_t pixel, uint8_t r, uint8_t g, uint8_t b);  // write color to pixel in buffer
-void NEO_writeHue(uint8_t pixel, uint8_t hue, uint8_t bright);        // hue (0..191), brightness (0..2)
-void NEO_clearPixel(uint8_t pixel);                                   // clear one pixel in buffer
+void NEO_fill(uint8_t value);                                         // write value to pixels, keep buffer
+void NEO_writeColor(NEO_INDEX pixel, uint8_t r, uint8_t g, uint8_t b);// write color to pixel in buffer
+void NEO_writeHue(NEO_INDEX pixel, uint8_t hue, uint8_t bright);      // hue (0..191), brightness (0..2)
+void NEO_clearPixel(NEO_INDEX pixel);                                 // clear one pixel in buffer
+void NEO_dimPixel(NEO_INDEX pixel, uint8_t level);                    // scale pixel in buffer (0..255)
@@ -0,0 +1,168 @@
+// ===================================================================================
+// Runtime Settings for CH551, CH552 and CH554
+// ===================================================================================
+
+#include "settings.h"
+#include "flash.h"
+#include "timer.h"
+#include "config.h"
+#include "usb_cdc.h"
+
+#define SET_SLOTS     (FLASH_SIZE / 4)                  // number of records
+#define SET_PAIRS     ((sizeof(SET_DATA) + 1) / 2)      // number of byte pairs
+#define SET_GEN       0x80                              // generation bit of record
+#define SET_SPARE     4                                 // min free slots in the ring
+#define SET_SIZE_V1   54                                // size of the first layout
+
+// Every pair needs a slot, and the ring needs free slots to rotate in, otherwise
+// SET_update() would overwrite the only valid record of a pair
+#if (SET_SIZE + 1) / 2 + SET_SPARE > FLASH_SIZE / 4
+  #error Runtime settings too large for the DataFlash ring (reduce MAP_SLOTS)
+#endif
+_Static_assert(sizeof(SET_DATA) == SET_SIZE, "SET_SIZE does not match SET_DATA");
+
+__xdata SET_DATA SET_data;                              // current settings
+__xdata uint8_t  SET_stored[sizeof(SET_DATA) + 1];      // settings in DataFlash
+uint8_t  SET_rec[4];                                    // record buffer
+uint8_t  SET_head;                                      // next record slot
+__bit    SET_gen;                                       // generation of current pass
+__bit    SET_dirtyFlag = 0;                             // settings changed flag
+uint16_t SET_dirtyTime;                                 // time of last change
+
+#define SET_bytes     ((__xdata uint8_t*)&SET_data)
+#define SET_default   ((__code  uint8_t*)&SET_defaults)
+
+// ===================================================================================
+// Record Functions
+// ===================================================================================
+
+// Calculate CRC-8 of record buffer, seeded with the settings size of its layout
+uint8_t SET_crc(uint8_t size) {
+  uint8_t i, j, crc = size;
+  for(i=0; i<3; i++) {
+    crc ^= SET_rec[i];
+    for(j=8; j; j--) crc = (crc & 1) ? (crc >> 1) ^ 0x8C : (crc >> 1);
+  }
+  return crc;
+}
+
+// Read record from slot into buffer, return the settings size of its layout if it
+// is valid, 0 otherwise. New fields are only appended to SET_DATA, so a record of
+// an older layout is still valid for the bytes that layout had.
+uint8_t SET_readRecord(uint8_t slot) {
+  uint8_t i, size;
+  slot <<= 2;
+  for(i=0; i<4; i++) SET_rec[i] = FLASH_read(slot + i);
+  i = (SET_rec[0] & ~SET_GEN) << 1;
+  for(size=sizeof(SET_DATA); size>=SET_SIZE_V1 && size>i; size--) {
+    if(SET_rec[3] == SET_crc(size)) return size;
+  }
+  return 0;
+}
+
+// Check if slot holds the only valid record of this pair
+uint8_t SET_isOnly(uint8_t slot, uint8_t pair) {
+  uint8_t i;
+  for(i=0; i<SET_SLOTS; i++) {
+    if(i == slot) continue;
+    if(SET_readRecord(i) && (SET_rec[0] & ~SET_GEN) == pair) return 0;
+  }
+  return 1;
+}
+
+// Write current value of pair as record at head and advance head
+void SET_writeRecord(uint8_t pair) {
+  uint8_t i, ofs = pair << 1;
+  SET_rec[0] = SET_gen ? (pair | SET_GEN) : pair;
+  SET_rec[1] = SET_stored[ofs]     = SET_bytes[ofs];
+  SET_rec[2] = SET_stored[ofs + 1] = (ofs + 1 < sizeof(SET_DATA)) ? SET_bytes[ofs + 1] : 0;
+  SET_rec[3] = SET_crc(sizeof(SET_DATA));
+  ofs = SET_head << 2;
+  for(i=0; i<4; i++) FLASH_write(ofs + i, SET_rec[i]);
+  if(++SET_head == SET_SLOTS) {                         // end of ring reached?
+    SET_head = 0;                                       // start next pass
+    SET_gen  = !SET_gen;
+  }
+}
+
+// ===================================================================================
+// Load Default Settings
+// ===================================================================================
+void SET_init(void) {
+  uint8_t i;
+  for(i=0; i<sizeof(SET_DATA); i++) SET_bytes[i] = SET_default[i];
+}
+
+// ===================================================================================
+// Load Settings from DataFlash
+// ===================================================================================
+void SET_load(void) {
+  uint8_t i, slot, size, gen = 0;
+
+  // Find head: first invalid record or first record of the previous pass
+  SET_init();
+  SET_head = 0;
+  if(SET_readRecord(0)) {
+    gen = SET_rec[0] & SET_GEN;
+    for(i=1; i<SET_SLOTS; i++) {
+      if(!SET_readRecord(i) || (SET_rec[0] & SET_GEN) != gen) {
+        SET_head = i;
+        break;
+      }
+    }
+  }
+  if(SET_head) SET_gen = gen;                           // continue current pass
+  else SET_gen = !(SET_readRecord(SET_SLOTS - 1) && (SET_rec[0] & SET_GEN));
+
+  // Replay records from oldest to newest, fields added after a record's layout
+  // keep their defaults
+  slot = SET_head;
+  do {
+    size = SET_readRecord(slot);
+    if(size) {
+      i = (SET_rec[0] & ~SET_GEN) << 1;
+      SET_bytes[i] = SET_rec[1];
+      if(++i < size) SET_bytes[i] = SET_rec[2];
+    }
+    slot = (slot + 1) & (SET_SLOTS - 1);
+  } while(slot != SET_head);
+  for(i=0; i<sizeof(SET_DATA); i++) SET_stored[i] = SET_bytes[i];
+}
+
+// ===================================================================================
+// Mark Settings as Changed
+// ===================================================================================
+void SET_modified(void) {
+  SET_dirtyFlag = 1;
+  SET_dirtyTime = TIM_millis();
+}
+
+// ===================================================================================
+// Write Pending Changes to DataFlash (one record per call)
+// ===================================================================================
+void SET_update(void) {
+  uint8_t pair, ofs;
+  if(!SET_dirtyFlag) return;
+  if((uint16_t)(TIM_millis() - SET_dirtyTime) < SET_SAVE_DELAY_ms) return;
+
+  // Find changed pair
+  for(pair=0; pair<SET_PAIRS; pair++) {
+    ofs = pair << 1;
+    if(SET_bytes[ofs] != SET_stored[ofs]) break;
+    if(ofs + 1 < sizeof(SET_DATA) && SET_bytes[ofs + 1] != SET_stored[ofs + 1]) break;
+  }
+  if(pair == SET_PAIRS) {                               // everything stored?
+    SET_dirtyFlag = 0;
+    CDC_log("settings saved");
+    return;
+  }
+
+  // Keep the record at head alive if it holds the only copy of a non-default pair
+  if(SET_readRecord(SET_head)) {
+    ofs = (SET_rec[0] & ~SET_GEN) << 1;
+    if( (SET_stored[ofs] != SET_default[ofs]
+      || (ofs + 1 < sizeof(SET_DATA) && SET_stored[ofs + 1] != SET_default[ofs + 1]))
+      && SET_isOnly(SET_head, ofs >> 1) ) pair = ofs >> 1;
+  }
+  SET_writeRecord(pair);
+}
@@ -0,0 +1,81 @@
+// ===================================================================================
+// Runtime Settings for CH551, CH552 and CH554
+// ===================================================================================
+//
+// All parameters which can be changed at runtime (e.g. via the Raw HID interface)
+// are kept in one RAM structure, which is read directly by the scan loop. SET_load()
+// fills it once at boot with the compiled-in defaults and applies the changes stored
+// in DataFlash.
+//
+// DataFlash is organized as a ring log of 32 four-byte records. Each record holds
+// one aligned pair of settings bytes: [generation bit | pair index] [byte] [byte]
+// [CRC-8]. Records are written in ring order, so all DataFlash cells wear evenly;
+// the generation bit flips on every pass and marks the write position. At boot the
+// records are replayed from oldest to newest, records with a bad CRC (e.g. torn by
+// a power loss) are ignored. Before a record is overwritten, it is rewritten at the
+// head if it still holds the only copy of a non-default pair. Since the settings
+// have fewer pairs than there are records, this always terminates.
+//
+// Changes are written deferred: SET_modified() marks the settings as changed,
+// SET_update() (called from the main loop) writes one record per call once the
+// settings have not been changed for SET_SAVE_DELAY_ms.
+//
+// SET_defaults must be defined in the main file.
+// The following must be defined in config.h:
+// SET_SAVE_DELAY_ms    - delay between last change and writing to DataFlash
+
+#pragma once
+#include <stdint.h>
+
+// Keymap slots (keys and encoder events)
+#define MAP_KEY1            0
+#define MAP_KEY2            1
+#define MAP_KEY3            2
+#define MAP_KEY4            3
+#define MAP_KEY5            4
+#define MAP_KEY6            5
+#define MAP_ENC_CW          6
+#define MAP_ENC_CCW         7
+#define MAP_ENC_PUSH_CW     8
+#define MAP_ENC_PUSH_CCW    9
+#define MAP_ENC_CLICK       10
+#define MAP_ENC_DOUBLE      11
+#define MAP_ENC_TRIPLE      12
+#define MAP_ENC_LONG        13
+#define MAP_SLOTS           14
+
+#define SET_KEYS            6       // number of keys with a NeoPixel
+#define SET_HUES            192     // hue values 0..191
+#define SET_BRIGHT_MAX      2       // max NeoPixel brightness
+
+// Keymap entry
+typedef struct _MAP_ENTRY {
+  uint8_t type;                     // action type (MAP_DEFAULT, MAP_KEY, ...)
+  uint8_t code;                     // key code, usage or button mask
+  uint8_t param;                    // modifier mask or additional parameter
+} MAP_ENTRY;
+
+// Runtime settings (max. 56 bytes to leave free records in DataFlash, see settings.c)
+// New fields must be appended, so that stored records of older layouts stay valid
+typedef struct _SET_DATA {
+  MAP_ENTRY keymap[MAP_SLOTS];      // actions of keys and encoder events
+  uint8_t hue[SET_KEYS];            // key colors (hue value: 0..191)
+  uint8_t brightKeys;               // NeoPixel brightness for keys (0..2)
+  uint8_t brightEnc;                // NeoPixel brightness for encoder ring (0..2)
+  uint8_t scanDelay;                // main loop delay in ms
+  uint8_t encDebounce;              // encoder switch/detent debounce time in ms
+  uint8_t clickGap;                 // max gap between clicks in 10ms units
+  uint8_t longPress;                // long press time in 10ms units
+  uint8_t uniMode;                  // Unicode input method of host (UNI_LINUX, ...)
+  uint8_t ringMode;                 // encoder ring (NEO_RING_RAINBOW, NEO_RING_GAUGE)
+} SET_DATA;
+
+#define SET_SIZE  (MAP_SLOTS * 3 + SET_KEYS + 8)  // sizeof(SET_DATA) for preprocessor checks
+
+extern __xdata SET_DATA SET_data;   // current settings
+extern __code SET_DATA SET_defaults;// compiled-in defaults (main file)
+
+void SET_init(void);                // load default settings
+void SET_load(void);                // load default settings and apply DataFlash log
+void SET_modified(void);            // mark settings as changed
+void SET_update(void);              // write pending changes (call in main loop)
@@ -0,0 +1,25 @@
+// ===================================================================================
+// Runtime Statistics for CH551, CH552 and CH554
+// ===================================================================================
+
+#include "stats.h"
+#include "timer.h"
+
+uint16_t STAT_scanRate;                     // main loop iterations per second
+uint16_t STAT_reports;                      // number of HID reports sent
+uint16_t STAT_configTime;                   // ms until configured by host
+uint16_t STAT_firstReport;                  // ms until first HID report was sent
+uint16_t STAT_scanCount;                    // iterations in current second
+uint16_t STAT_scanTime;                     // start of current second
+
+// ===================================================================================
+// Count Main Loop Iteration
+// ===================================================================================
+void STAT_scan(void) {
+  STAT_scanCount++;
+  if((uint16_t)(TIM_millis() - STAT_scanTime) >= 1000) {
+    STAT_scanTime += 1000;
+    STAT_scanRate  = STAT_scanCount;
+    STAT_scanCount = 0;
+  }
+}
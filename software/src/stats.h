@@ -0,0 +1,16 @@
+// ===================================================================================
+// Runtime Statistics for CH551, CH552 and CH554
+// ===================================================================================
+//
+// Simple counters which can be read via the Raw HID interface. STAT_scan() must be
+// called once per main loop iteration.
+
+#pragma once
+#include <stdint.h>
+
+extern uint16_t STAT_scanRate;              // main loop iterations per second
+extern uint16_t STAT_reports;               // number of HID reports sent (wraps)
+extern uint16_t STAT_configTime;            // ms from USB init until configured
+extern uint16_t STAT_firstReport;           // ms from USB init until first report sent
+
+void STAT_scan(void);                       // count main loop iteration
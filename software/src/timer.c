@@ -0,0 +1,64 @@
+// ===================================================================================
+// Millisecond System Tick Functions for CH551, CH552 and CH554
+// ===================================================================================
+//
+// Timer2 runs in 16-bit auto-reload mode and increments a free-running millisecond
+// counter. It is used to time events without blocking the main loop.
+
+#include "ch554.h"
+#include "timer.h"
+
+// Timer2 clock is Fsys/12, reload value for a period of 1ms
+#define TIM_RELOAD  (65536 - (F_CPU / 12 / 1000))
+
+volatile uint16_t TIM_ticks;                // millisecond counter
+
+#if USB_CDC
+__xdata uint16_t TIM_latency[TIM_LAT_BUCKETS];  // interrupt latency histogram
+#endif
+
+// ===================================================================================
+// Init and Start System Tick
+// ===================================================================================
+void TIM_init(void) {
+  T2CON     = 0;                            // timer mode, auto reload, stopped
+  T2MOD    &= ~(bTMR_CLK | bT2_CLK);        // standard clock Fsys/12
+  RCAP2     = TIM_RELOAD;                   // set reload value
+  T2COUNT   = TIM_RELOAD;                   // set first period
+  TIM_ticks = 0;                            // reset counter
+  ET2       = 1;                            // enable timer2 interrupt
+  TR2       = 1;                            // start timer2
+  EA        = 1;                            // enable global interrupts
+}
+
+// ===================================================================================
+// Get Milliseconds since TIM_init()
+// ===================================================================================
+uint16_t TIM_millis(void) {
+  uint16_t ms;
+  ET2 = 0;                                  // 16-bit read is not atomic
+  ms  = TIM_ticks;
+  ET2 = 1;
+  return ms;
+}
+
+// ===================================================================================
+// Timer2 Interrupt Handler
+// ===================================================================================
+#pragma save
+#pragma nooverlay
+void TIM_interrupt(void) {
+  #if USB_CDC
+  uint16_t lat = T2COUNT - TIM_RELOAD;      // ticks since overflow, read first
+  uint8_t  b = 0;
+  lat >>= 2;
+  while(lat && b < TIM_LAT_BUCKETS - 1) {   // bucket: log2 of latency
+    lat >>= 1;
+    b++;
+  }
+  if(TIM_latency[b] != 0xFFFF) TIM_latency[b]++;
+  #endif
+  TF2 = 0;                                  // clear interrupt flag
+  TIM_ticks++;                              // count milliseconds
+}
+#pragma restore
@@ -0,0 +1,27 @@
+// ===================================================================================
+// Millisecond System Tick Functions for CH551, CH552 and CH554
+// ===================================================================================
+//
+// Timer2 runs in 16-bit auto-reload mode and increments a free-running millisecond
+// counter. It is used to time events without blocking the main loop.
+//
+// TIM_interrupt() must be called by the timer2 interrupt (INT_NO_TMR2) in the
+// main file. Use 16-bit differences for timing: (uint16_t)(TIM_millis() - start).
+//
+// With the USB_CDC console enabled, the interrupt also records its own latency
+// (timer2 ticks since the overflow, i.e. how long interrupts were blocked) in a
+// histogram. Bucket i counts latencies below 4 << i ticks (3us << i at 16 MHz), the
+// last bucket everything above. The counters saturate at 65535.
+
+#pragma once
+#include <stdint.h>
+#include "config.h"
+
+void TIM_init(void);                        // init and start system tick
+uint16_t TIM_millis(void);                  // get milliseconds since TIM_init()
+void TIM_interrupt(void);                   // timer2 interrupt handler
+
+#if USB_CDC
+#define TIM_LAT_BUCKETS 8                   // number of latency histogram buckets
+extern __xdata uint16_t TIM_latency[TIM_LAT_BUCKETS]; // latency histogram
+#endif
@@ -0,0 +1,137 @@
+// ===================================================================================
+// Unicode Text Entry for CH551, CH552 and CH554
+// ===================================================================================
+
+#include "unicode.h"
+#include "settings.h"
+#include "kbd_layout.h"
+#include "usb_composite.h"
+
+// Modifier bits in keyboard report
+#define UNI_MOD_CTRL        0x01
+#define UNI_MOD_SHIFT       0x02
+#define UNI_MOD_ALT         0x04                // Option on macOS
+
+// Keycodes
+#define UNI_KEY_SPACE       0x2C
+#define UNI_KEY_KP_PLUS     0x57
+#define UNI_KEY_KP_1        0x59
+#define UNI_KEY_KP_0        0x62
+
+uint8_t UNI_lastKey;                            // last key of packed sequence
+
+// ===================================================================================
+// Packed Key Sequence
+// ===================================================================================
+
+// Press key, the previous key of the sequence is released in the same report
+void UNI_key(uint8_t mod, uint8_t key) {
+  if(key == UNI_lastKey) KBD_sendCode(mod, 0);  // same key needs a release first
+  KBD_sendCode(mod, key);
+  UNI_lastKey = key;
+}
+
+// Release last key of sequence with modifiers kept
+void UNI_release(uint8_t mod) {
+  KBD_sendCode(mod, 0);
+  UNI_lastKey = 0;
+}
+
+// Type a character of the host layout
+void UNI_char(uint8_t mod, uint8_t c) {
+  c = KBD_map[c];
+  UNI_key((c & 0x80) ? (mod | UNI_MOD_SHIFT) : mod, c & 0x7F);
+}
+
+// Type hex digit
+void UNI_digit(uint8_t mod, uint8_t d) {
+  if(SET_data.uniMode == UNI_MACOS)             // Unicode Hex Input: US positions
+    UNI_key(mod, d ? (d < 10 ? 0x1D + d : 0x04 - 10 + d) : 0x27);
+  else if(SET_data.uniMode == UNI_WINDOWS && d < 10)  // numpad digits
+    UNI_key(mod, d ? UNI_KEY_KP_1 - 1 + d : UNI_KEY_KP_0);
+  else UNI_char(mod, d < 10 ? '0' + d : 'a' - 10 + d);
+}
+
+// Type value as hex number with at least the given number of digits
+void UNI_hex(uint8_t mod, uint32_t value, uint8_t digits) {
+  uint8_t i, d;
+  for(i=6; i; i--) {
+    d = (value >> ((i - 1) << 2)) & 0x0F;
+    if(d || i <= digits) {
+      UNI_digit(mod, d);
+      digits = i;                               // no more leading zeros to skip
+    }
+  }
+}
+
+// ===================================================================================
+// Input Method Selection
+// ===================================================================================
+void UNI_setMode(uint8_t mode) {
+  if(mode >= UNI_MODES || mode == SET_data.uniMode) return;
+  SET_data.uniMode = mode;
+  SET_modified();                               // store in DataFlash
+}
+
+void UNI_nextMode(void) {
+  UNI_setMode(SET_data.uniMode < UNI_MODES - 1 ? SET_data.uniMode + 1 : 0);
+}
+
+// ===================================================================================
+// Type Unicode Code Point
+// ===================================================================================
+void UNI_type(uint32_t cp) {
+  switch(SET_data.uniMode) {
+    case UNI_LINUX:
+      UNI_char(UNI_MOD_CTRL | UNI_MOD_SHIFT, 'u');
+      UNI_release(0);                           // let go of the chord
+      UNI_hex(0, cp, 1);
+      UNI_key(0, UNI_KEY_SPACE);                // commit
+      break;
+    case UNI_WINDOWS:
+      if(cp >= 0xA0 && cp < 0x100) {            // Latin-1: Alt+0ddd (ANSI code page)
+        UNI_key(UNI_MOD_ALT, UNI_KEY_KP_0);
+        UNI_digit(UNI_MOD_ALT, (uint8_t)cp / 100);
+        UNI_digit(UNI_MOD_ALT, (uint8_t)cp / 10 % 10);
+        UNI_digit(UNI_MOD_ALT, (uint8_t)cp % 10);
+      }
+      else {                                    // Alt+(numpad plus)hex
+        UNI_key(UNI_MOD_ALT, UNI_KEY_KP_PLUS);
+        UNI_hex(UNI_MOD_ALT, cp, 1);
+      }
+      UNI_release(UNI_MOD_ALT);                 // releasing Alt commits
+      break;
+    case UNI_MACOS:
+      if(cp > 0xFFFF) {                         // surrogate pair
+        cp -= 0x10000;
+        UNI_hex(UNI_MOD_ALT, 0xD800 | (cp >> 10), 4);
+        cp = 0xDC00 | (cp & 0x3FF);
+      }
+      UNI_hex(UNI_MOD_ALT, cp, 4);
+      UNI_release(UNI_MOD_ALT);
+      break;
+    default:
+      return;
+  }
+  UNI_release(0);
+  KBD_restore();                                // press held keys again
+}
+
+// ===================================================================================
+// Type UTF-8 String
+// ===================================================================================
+void UNI_print(__code char* str) {
+  uint32_t cp;
+  uint8_t c, n;
+  while((c = *str++)) {
+    if(c < 0x80) {                              // ASCII: type with host layout
+      KBD_type(c);
+      continue;
+    }
+    if(c >= 0xF0)      { cp = c & 0x07; n = 3; }  // decode UTF-8 sequence
+    else if(c >= 0xE0) { cp = c & 0x0F; n = 2; }
+    else               { cp = c & 0x1F; n = 1; }
+    while(n-- && (*str & 0xC0) == 0x80) cp = (cp << 6) | (*str++ & 0x3F);
+    UNI_type(cp);
+  }
+}
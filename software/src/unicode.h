@@ -0,0 +1,33 @@
+// ===================================================================================
+// Unicode Text Entry for CH551, CH552 and CH554
+// ===================================================================================
+//
+// Types Unicode code points with the input method of the host operating system:
+// UNI_LINUX    Ctrl+Shift+U, hex code, space (IBus/GTK)
+// UNI_WINDOWS  Alt+numpad 0+decimal code for U+00A0..U+00FF (the ANSI code page
+//              only matches Latin-1 there), Alt+numpad plus+hex code otherwise
+//              (needs registry value HKCU\Control Panel\Input Method
+//              EnableHexNumpad = "1")
+// UNI_MACOS    Option+4-digit hex code, surrogate pairs above U+FFFF (needs input
+//              source "Unicode Hex Input")
+// The method is part of the runtime settings (SET_data.uniMode), so it can be
+// changed by a key action and is kept in DataFlash. The key sequences are packed:
+// consecutive different keys are released and pressed within the same report.
+// Held keys are released during a sequence and pressed again afterwards.
+//
+// The following must be defined in config.h:
+// UNI_MODE             - default input method
+
+#pragma once
+#include <stdint.h>
+
+// Input methods
+#define UNI_LINUX           0
+#define UNI_WINDOWS         1
+#define UNI_MACOS           2
+#define UNI_MODES           3
+
+void UNI_setMode(uint8_t mode);             // select input method of host
+void UNI_nextMode(void);                    // cycle through input methods
+void UNI_type(uint32_t cp);                 // type one Unicode code point
+void UNI_print(__code char* str);           // type UTF-8 string
@@ -55,6 +55,13 @@
 #define HID_SET_PROTOCOL        0x0B
 #endif
 
+// USB HID report types (high byte of wValue in GET/SET_REPORT)
+#ifndef HID_REPORT_TYP_INPUT
+#define HID_REPORT_TYP_INPUT    0x01
+#define HID_REPORT_TYP_OUTPUT   0x02
+#define HID_REPORT_TYP_FEATURE  0x03
+#endif
+
 // Bit define for USB request type
 #ifndef USB_REQ_TYP_MASK
 #define USB_REQ_TYP_IN          0x80  // control IN, device to host
@@ -115,6 +122,8 @@
 #define USB_DESCR_TYP_SPEED     0x07
 #define USB_DESCR_TYP_OTG       0x09
 #define USB_DESCR_TYP_IAD       0x0B
+#define USB_DESCR_TYP_BOS       0x0F
+#define USB_DESCR_TYP_DEVCAP    0x10
 #define USB_DESCR_TYP_HID       0x21
 #define USB_DESCR_TYP_REPORT    0x22
 #define USB_DESCR_TYP_PHYSIC    0x23
@@ -294,6 +303,202 @@ typedef struct _USB_HID_DESCR {
 } USB_HID_DESCR, *PUSB_HID_DESCR;
 typedef USB_HID_DESCR __xdata *PXUSB_HID_DESCR;
 
+// USB Audio/MIDI class (USB Device Class Definition for MIDI Devices 1.0)
+#define USB_AUDIO_SUBCLASS_CONTROL      0x01
+#define USB_AUDIO_SUBCLASS_MIDI         0x03
+#define USB_MIDI_HEADER                 0x01    // class-specific descriptor subtypes
+#define USB_MIDI_IN_JACK                0x02
+#define USB_MIDI_OUT_JACK               0x03
+#define USB_MIDI_GENERAL                0x01
+#define USB_MIDI_JACK_EMBEDDED          0x01    // jack types
+#define USB_MIDI_JACK_EXTERNAL          0x02
+
+typedef struct _USB_AC_HEADER_DESCR {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint8_t  bDescriptorSubtype;
+    uint16_t bcdADC;
+    uint16_t wTotalLength;
+    uint8_t  bInCollection;
+    uint8_t  baInterfaceNr;
+} USB_AC_HEADER_DESCR, *PUSB_AC_HEADER_DESCR;
+
+typedef struct _USB_MS_HEADER_DESCR {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint8_t  bDescriptorSubtype;
+    uint16_t bcdMSC;
+    uint16_t wTotalLength;
+} USB_MS_HEADER_DESCR, *PUSB_MS_HEADER_DESCR;
+
+typedef struct _USB_MIDI_IN_JACK_DESCR {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint8_t  bDescriptorSubtype;
+    uint8_t  bJackType;
+    uint8_t  bJackID;
+    uint8_t  iJack;
+} USB_MIDI_IN_JACK_DESCR, *PUSB_MIDI_IN_JACK_DESCR;
+
+typedef struct _USB_MIDI_OUT_JACK_DESCR {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint8_t  bDescriptorSubtype;
+    uint8_t  bJackType;
+    uint8_t  bJackID;
+    uint8_t  bNrInputPins;
+    uint8_t  baSourceID;
+    uint8_t  baSourcePin;
+    uint8_t  iJack;
+} USB_MIDI_OUT_JACK_DESCR, *PUSB_MIDI_OUT_JACK_DESCR;
+
+typedef struct _USB_AUDIO_ENDP_DESCR {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint8_t  bEndpointAddress;
+    uint8_t  bmAttributes;
+    uint16_t wMaxPacketSize;
+    uint8_t  bInterval;
+    uint8_t  bRefresh;
+    uint8_t  bSynchAddress;
+} USB_AUDIO_ENDP_DESCR, *PUSB_AUDIO_ENDP_DESCR;
+
+typedef struct _USB_MS_ENDP_DESCR {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint8_t  bDescriptorSubtype;
+    uint8_t  bNumEmbMIDIJack;
+    uint8_t  baAssocJackID;
+} USB_MS_ENDP_DESCR, *PUSB_MS_ENDP_DESCR;
+
+// USB Communications Device Class (CDC 1.1, abstract control model)
+#define USB_CDC_SUBCLASS_ACM            0x02
+#define USB_CDC_HEADER                  0x00    // functional descriptor subtypes
+#define USB_CDC_CALL_MGMT               0x01
+#define USB_CDC_ACM                     0x02
+#define USB_CDC_UNION                   0x06
+#define CDC_SET_LINE_CODING             0x20    // class requests
+#define CDC_GET_LINE_CODING             0x21
+#define CDC_SET_CONTROL_LINE_STATE      0x22
+
+typedef struct _USB_CDC_HEADER_DESCR {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint8_t  bDescriptorSubtype;
+    uint16_t bcdCDC;
+} USB_CDC_HEADER_DESCR, *PUSB_CDC_HEADER_DESCR;
+
+typedef struct _USB_CDC_CALL_MGMT_DESCR {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint8_t  bDescriptorSubtype;
+    uint8_t  bmCapabilities;
+    uint8_t  bDataInterface;
+} USB_CDC_CALL_MGMT_DESCR, *PUSB_CDC_CALL_MGMT_DESCR;
+
+typedef struct _USB_CDC_ACM_DESCR {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint8_t  bDescriptorSubtype;
+    uint8_t  bmCapabilities;
+} USB_CDC_ACM_DESCR, *PUSB_CDC_ACM_DESCR;
+
+typedef struct _USB_CDC_UNION_DESCR {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint8_t  bDescriptorSubtype;
+    uint8_t  bMasterInterface;
+    uint8_t  bSlaveInterface0;
+} USB_CDC_UNION_DESCR, *PUSB_CDC_UNION_DESCR;
+
+// Binary device Object Store (USB 2.1) with platform capabilities
+#define USB_DEVCAP_PLATFORM             0x05    // platform capability type
+
+typedef struct _USB_BOS_DESCR {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint16_t wTotalLength;
+    uint8_t  bNumDeviceCaps;
+} USB_BOS_DESCR, *PUSB_BOS_DESCR;
+
+// WebUSB (platform capability, GET_URL vendor request, URL descriptor)
+#define WEBUSB_REQUEST_GET_URL          0x02    // wIndex of vendor request
+#define WEBUSB_DESCR_TYP_URL            0x03
+#define WEBUSB_URL_SCHEME_HTTPS         0x01
+
+typedef struct _USB_WEBUSB_CAP_DESCR {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint8_t  bDevCapabilityType;
+    uint8_t  bReserved;
+    uint8_t  PlatformCapabilityUUID[16];
+    uint16_t bcdVersion;
+    uint8_t  bVendorCode;
+    uint8_t  iLandingPage;
+} USB_WEBUSB_CAP_DESCR, *PUSB_WEBUSB_CAP_DESCR;
+
+// Microsoft OS 2.0 descriptors (platform capability and descriptor set)
+#define MS_OS_20_DESCRIPTOR_INDEX       0x07    // wIndex of vendor request
+#define MS_OS_20_SET_HEADER             0x0000  // descriptor types
+#define MS_OS_20_SUBSET_CONFIGURATION   0x0001
+#define MS_OS_20_SUBSET_FUNCTION        0x0002
+#define MS_OS_20_FEATURE_COMPATIBLE_ID  0x0003
+#define MS_OS_20_FEATURE_REG_PROPERTY   0x0004
+#define MS_OS_20_WINDOWS_8_1            0x06030000
+#define MS_OS_20_REG_MULTI_SZ           0x0007
+
+typedef struct _USB_MSOS20_CAP_DESCR {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint8_t  bDevCapabilityType;
+    uint8_t  bReserved;
+    uint8_t  PlatformCapabilityUUID[16];
+    uint32_t dwWindowsVersion;
+    uint16_t wMSOSDescriptorSetTotalLength;
+    uint8_t  bMS_VendorCode;
+    uint8_t  bAltEnumCode;
+} USB_MSOS20_CAP_DESCR, *PUSB_MSOS20_CAP_DESCR;
+
+typedef struct _MS_OS_20_SET_HEADER_DESCR {
+    uint16_t wLength;
+    uint16_t wDescriptorType;
+    uint32_t dwWindowsVersion;
+    uint16_t wTotalLength;
+} MS_OS_20_SET_HEADER_DESCR;
+
+typedef struct _MS_OS_20_CONFIG_SUBSET_DESCR {
+    uint16_t wLength;
+    uint16_t wDescriptorType;
+    uint8_t  bConfigurationValue;
+    uint8_t  bReserved;
+    uint16_t wTotalLength;
+} MS_OS_20_CONFIG_SUBSET_DESCR;
+
+typedef struct _MS_OS_20_FUNCTION_SUBSET_DESCR {
+    uint16_t wLength;
+    uint16_t wDescriptorType;
+    uint8_t  bFirstInterface;
+    uint8_t  bReserved;
+    uint16_t wSubsetLength;
+} MS_OS_20_FUNCTION_SUBSET_DESCR;
+
+typedef struct _MS_OS_20_COMPATIBLE_ID_DESCR {
+    uint16_t wLength;
+    uint16_t wDescriptorType;
+    uint8_t  CompatibleID[8];
+    uint8_t  SubCompatibleID[8];
+} MS_OS_20_COMPATIBLE_ID_DESCR;
+
+typedef struct _MS_OS_20_GUIDS_PROPERTY_DESCR {     // registry property
+    uint16_t wLength;                               // "DeviceInterfaceGUIDs"
+    uint16_t wDescriptorType;
+    uint16_t wPropertyDataType;
+    uint16_t wPropertyNameLength;
+    uint16_t PropertyName[21];
+    uint16_t wPropertyDataLength;
+    uint16_t PropertyData[40];
+} MS_OS_20_GUIDS_PROPERTY_DESCR;
+
 typedef struct _UDISK_BOC_CBW {             // command of BulkOnly USB-FlashDisk
     uint8_t mCBW_Sig0;
     uint8_t mCBW_Sig1;
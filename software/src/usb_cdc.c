@@ -0,0 +1,327 @@
+// ===================================================================================
+// USB CDC-ACM Debug Console for CH551, CH552 and CH554
+// ===================================================================================
+
+#include "ch554.h"
+#include "usb.h"
+#include "usb_cdc.h"
+#include "usb_handler.h"
+#include "usb_hid.h"
+#include "timer.h"
+#include "stats.h"
+
+#if USB_CDC
+
+#define CDC_TX_SIZE     128                                 // output ring (power of 2)
+#define CDC_LOG_SIZE    64                                  // log ring buffer
+#define CDC_LINE_SIZE   16                                  // max command length + 1
+
+#define CDC_rxBuffer  (EP4_buffer)                          // command input
+#define CDC_txBuffer  (EP4_buffer + EP4_SIZE)               // console output
+
+__xdata uint8_t CDC_tx[CDC_TX_SIZE];                        // output ring buffer
+volatile uint8_t CDC_txHead = 0;                            // written by main loop
+volatile uint8_t CDC_txTail = 0;                            // read by USB interrupt
+__xdata char CDC_logBuffer[CDC_LOG_SIZE];                   // log ring buffer
+uint8_t  CDC_logHead = 0;                                   // next log position
+__bit    CDC_logWrapped = 0;                                // log buffer was filled
+__bit    CDC_toLog = 0;                                     // write to log, not output
+__xdata char CDC_line[CDC_LINE_SIZE];                       // command line
+uint8_t  CDC_lineLen = 0;                                   // characters in line
+__bit    CDC_live = 0;                                      // live output enabled
+uint16_t CDC_liveTime;                                      // time of last live output
+
+volatile uint8_t CDC_rxLen;                                 // length of input packet
+volatile __bit CDC_readyFlag = 0;                           // input packet received
+volatile __bit CDC_writeBusyFlag = 0;                       // upload busy flag
+volatile __bit CDC_lineState = 0;                           // DTR set by terminal
+__bit CDC_lineCodingFlag = 0;                               // SET_LINE_CODING pending
+__xdata uint8_t CDC_lineCoding[7] = {0x00, 0xC2, 0x01, 0x00, 0, 0, 8}; // 115200 8N1
+
+// Upper bound of the latency buckets in us: 4 timer2 ticks (Fsys/12) per unit
+#define CDC_LAT_UNIT_us (48000000UL / F_CPU)
+
+// ===================================================================================
+// Output Functions
+// ===================================================================================
+
+// Write character to output ring buffer (or to log), drop it if buffer is full
+void CDC_write(char c) {
+  uint8_t next;
+  if(CDC_toLog) {
+    CDC_logBuffer[CDC_logHead++] = c;
+    if(CDC_logHead == CDC_LOG_SIZE) {
+      CDC_logHead    = 0;
+      CDC_logWrapped = 1;
+    }
+    return;
+  }
+  next = (CDC_txHead + 1) & (CDC_TX_SIZE - 1);
+  if(next == CDC_txTail) return;                            // buffer full: drop
+  CDC_tx[CDC_txHead] = c;
+  CDC_txHead = next;
+}
+
+// Write string
+void CDC_print(__code char* str) {
+  while(*str) CDC_write(*str++);
+}
+
+// Write decimal number
+void CDC_printNum(uint16_t value) {
+  char digits[5];
+  uint8_t i = 0;
+  do {
+    digits[i++] = '0' + value % 10;
+    value /= 10;
+  } while(value);
+  while(i) CDC_write(digits[--i]);
+}
+
+// Add line with millisecond timestamp to log
+void CDC_log(__code char* str) {
+  CDC_toLog = 1;
+  CDC_printNum(TIM_millis());
+  CDC_write(' ');
+  CDC_print(str);
+  CDC_print("\r\n");
+  CDC_toLog = 0;
+}
+
+// ===================================================================================
+// Console Commands
+// ===================================================================================
+
+// Get cause of last reset
+__code char* CDC_resetCause(void) {
+  switch(PCON & MASK_RST_FLAG) {
+    case RST_FLAG_SW:   return "software reset";
+    case RST_FLAG_POR:  return "power-on reset";
+    case RST_FLAG_WDOG: return "watchdog reset";
+    default:            return "pin reset";
+  }
+}
+
+// Write scan rate and report queue depth
+void CDC_printStat(void) {
+  CDC_print("scan ");    CDC_printNum(STAT_scanRate);
+  CDC_print("/s queue ");CDC_printNum(HID_queueLen);
+  CDC_write('/');        CDC_printNum(HID_QUEUE_SIZE);
+}
+
+// Write timer interrupt latency histogram and clear it
+void CDC_printLatency(void) {
+  uint8_t i;
+  uint16_t count;
+  for(i=0; i<TIM_LAT_BUCKETS; i++) {
+    ET2 = 0;                                                // 16-bit access is not atomic
+    count = TIM_latency[i];
+    TIM_latency[i] = 0;
+    ET2 = 1;
+    CDC_print(i < TIM_LAT_BUCKETS - 1 ? "<" : ">=");
+    CDC_printNum(CDC_LAT_UNIT_us << (i < TIM_LAT_BUCKETS - 1 ? i : i - 1));
+    CDC_print("us ");
+    CDC_printNum(count);
+    CDC_print("\r\n");
+  }
+}
+
+// Write log, oldest line first
+void CDC_printLog(void) {
+  uint8_t i, n;
+  char c;
+  __bit skip = CDC_logWrapped;                              // first line is cut off
+  i = CDC_logWrapped ? CDC_logHead : 0;
+  n = CDC_logWrapped ? CDC_LOG_SIZE : CDC_logHead;
+  for(; n; n--) {
+    c = CDC_logBuffer[i];
+    if(++i == CDC_LOG_SIZE) i = 0;
+    if(skip) {
+      if(c == '\n') skip = 0;
+      continue;
+    }
+    CDC_write(c);
+  }
+}
+
+// Compare command line with command
+__bit CDC_isCommand(__code char* cmd) {
+  uint8_t i = 0;
+  while(*cmd) if(CDC_line[i++] != *cmd++) return 0;
+  return(i == CDC_lineLen);
+}
+
+// Execute command line
+void CDC_execute(void) {
+  if(CDC_isCommand("help")) CDC_print("help stat live isr rst log\r\n");
+  else if(CDC_isCommand("stat")) {
+    CDC_printStat();
+    CDC_print(" reports ");   CDC_printNum(STAT_reports);
+    CDC_print(" config ");    CDC_printNum(STAT_configTime);
+    CDC_print("ms first ");   CDC_printNum(STAT_firstReport);
+    CDC_print("ms\r\n");
+  }
+  else if(CDC_isCommand("live")) {
+    CDC_live = !CDC_live;
+    CDC_liveTime = TIM_millis();
+    CDC_print(CDC_live ? "live on\r\n" : "live off\r\n");
+  }
+  else if(CDC_isCommand("isr")) CDC_printLatency();
+  else if(CDC_isCommand("rst")) {
+    CDC_print(CDC_resetCause());
+    CDC_print("\r\n");
+  }
+  else if(CDC_isCommand("log")) CDC_printLog();
+  else CDC_print("?\r\n");
+}
+
+// ===================================================================================
+// Front End Functions
+// ===================================================================================
+
+// Log cause of last reset
+void CDC_init(void) {
+  CDC_log(CDC_resetCause());
+}
+
+// Handle console input and output
+void CDC_process(void) {
+  uint8_t i;
+  char c;
+
+  // Read input packet once the previous output has been sent
+  if(CDC_readyFlag && CDC_txHead == CDC_txTail) {
+    for(i=0; i<CDC_rxLen; i++) {
+      c = CDC_rxBuffer[i];
+      if(c == '\r' || c == '\n') {                          // end of line?
+        if(!CDC_lineLen) continue;
+        CDC_print("\r\n");
+        CDC_execute();
+        CDC_lineLen = 0;
+        CDC_print("> ");
+      }
+      else if(c == '\b' || c == 0x7F) {                     // backspace?
+        if(!CDC_lineLen) continue;
+        CDC_lineLen--;
+        CDC_print("\b \b");
+      }
+      else if(c >= ' ' && CDC_lineLen < CDC_LINE_SIZE - 1) {
+        CDC_line[CDC_lineLen++] = c;
+        CDC_write(c);                                       // echo
+      }
+    }
+    CDC_readyFlag = 0;
+    IE_USB = 0;                                             // EP4 IN may change UEP4_CTRL
+    UEP4_CTRL = UEP4_CTRL & ~MASK_UEP_R_RES | UEP_R_RES_ACK;// accept next packet
+    IE_USB = 1;
+  }
+
+  // Live output once per second
+  if(CDC_live && CDC_lineState && (uint16_t)(TIM_millis() - CDC_liveTime) >= 1000) {
+    CDC_liveTime = TIM_millis();
+    CDC_printStat();
+    CDC_print("\r\n");
+  }
+
+  // Upload next packet (here and not in the USB interrupt, so that no handler runs
+  // long enough to latch NeoPixels between two segments, see neo.h)
+  if(CDC_lineState && !CDC_writeBusyFlag && CDC_txHead != CDC_txTail) {
+    IE_USB = 0;
+    CDC_upload();
+    IE_USB = 1;
+  }
+}
+
+// ===================================================================================
+// CDC USB Handler Functions
+// ===================================================================================
+
+// Upload next packet from output ring buffer via EP4 (IE_USB = 0). Packets are kept
+// shorter than EP4_SIZE, so no zero-length packet is needed to end a transfer.
+void CDC_upload(void) {
+  uint8_t len = 0;
+  while(len < EP4_SIZE - 1 && CDC_txTail != CDC_txHead) {
+    CDC_txBuffer[len++] = CDC_tx[CDC_txTail];
+    CDC_txTail = (CDC_txTail + 1) & (CDC_TX_SIZE - 1);
+  }
+  UEP4_T_LEN = len;
+  CDC_writeBusyFlag = (len != 0);
+  UEP4_CTRL = UEP4_CTRL & ~MASK_UEP_T_RES | (len ? UEP_T_RES_ACK : UEP_T_RES_NAK);
+}
+
+// Setup EP2 IN (buffer at EP2_ADDR + 64) and EP4 (buffers at EP0 + 64, fixed)
+void CDC_setup(void) {
+  CDC_reset();
+  UEP2_3_MOD |= bUEP2_TX_EN;                                // EP2 TX enable
+  UEP4_1_MOD |= bUEP4_RX_EN | bUEP4_TX_EN;                  // EP4 RX and TX enable
+}
+
+// Reset CDC parameters (pending output is kept)
+void CDC_reset(void) {
+  UEP2_T_LEN = 0;
+  UEP2_CTRL  = UEP2_CTRL & ~MASK_UEP_T_RES | UEP_T_RES_NAK; // no notifications
+  UEP4_T_LEN = 0;
+  UEP4_CTRL  = UEP_T_RES_NAK | UEP_R_RES_ACK;               // EP4 has no auto toggle
+  CDC_writeBusyFlag  = 0;
+  CDC_readyFlag      = 0;
+  CDC_lineState      = 0;
+  CDC_lineCodingFlag = 0;
+}
+
+// Endpoint 2 IN handler (notifications, never sent)
+void CDC_EP2_IN(void) {
+  UEP2_T_LEN = 0;
+  UEP2_CTRL = UEP2_CTRL & ~MASK_UEP_T_RES | UEP_T_RES_NAK;  // default NAK
+}
+
+// Endpoint 4 IN handler (console output to host)
+void CDC_EP4_IN(void) {
+  UEP4_CTRL ^= bUEP_T_TOG;                                  // manual data toggle
+  UEP4_T_LEN = 0;
+  UEP4_CTRL  = UEP4_CTRL & ~MASK_UEP_T_RES | UEP_T_RES_NAK; // next packet by CDC_process()
+  CDC_writeBusyFlag = 0;
+}
+
+// Endpoint 4 OUT handler (console input from host)
+void CDC_EP4_OUT(void) {
+  if(U_TOG_OK) {                                            // synchronized packet?
+    UEP4_CTRL ^= bUEP_R_TOG;                                // manual data toggle
+    UEP4_CTRL = UEP4_CTRL & ~MASK_UEP_R_RES | UEP_R_RES_NAK;// hold until processed
+    CDC_rxLen = USB_RX_LEN;
+    CDC_readyFlag = 1;
+  }
+}
+
+// Handle CDC class request (SETUP stage), return length of data or 0xFF to stall
+uint8_t CDC_CTRL_request(void) {
+  uint8_t i;
+  switch(SetupReq) {
+    case CDC_GET_LINE_CODING:
+      for(i=0; i<7; i++) EP0_buffer[i] = CDC_lineCoding[i];
+      return(SetupLen < 7 ? SetupLen : 7);
+    case CDC_SET_LINE_CODING:
+      if(SetupLen) CDC_lineCodingFlag = 1;                  // data stage follows
+      return 0;
+    case CDC_SET_CONTROL_LINE_STATE:
+      CDC_lineState = USB_setupBuf->wValueL & 1;            // DTR: terminal opened
+      return 0;
+    default:
+      return 0xFF;                                          // request not supported
+  }
+}
+
+// Drop pending SET_LINE_CODING data stage (new SETUP)
+void CDC_CTRL_cancel(void) {
+  CDC_lineCodingFlag = 0;
+}
+
+// Handle data stage of CDC class request, return 1 if it was consumed
+uint8_t CDC_CTRL_OUT(void) {
+  uint8_t i;
+  if(!CDC_lineCodingFlag) return 0;                         // no SET_LINE_CODING pending
+  for(i=0; i<7 && i<USB_RX_LEN; i++) CDC_lineCoding[i] = EP0_buffer[i];
+  CDC_lineCodingFlag = 0;
+  return 1;
+}
+
+#endif // USB_CDC
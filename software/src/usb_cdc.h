@@ -0,0 +1,54 @@
+// ===================================================================================
+// USB CDC-ACM Debug Console for CH551, CH552 and CH554
+// ===================================================================================
+//
+// Optional virtual serial port (interfaces 2 and 3 with interface association, bulk
+// IN/OUT on EP4, notification endpoint EP2 IN) with a line-based console for field
+// diagnosis. Open it with any terminal program, the line coding is ignored.
+//
+// Command   Output
+// help      list of commands
+// stat      scan rate, HID report queue depth, reports sent, time to configuration
+//           and to first report
+// live      toggle output of scan rate and queue depth once per second
+// isr       timer interrupt latency histogram since the last call (see timer.h)
+// rst       cause of the last reset
+// log       log ring buffer, oldest line first
+//
+// Output is written into a ring buffer, which is drained by CDC_process() one packet
+// per call, full ring buffers drop characters, so the scan loop is never blocked.
+// Input is only flagged by the USB interrupt and executed by CDC_process(), which
+// must be called from the main loop. CDC_log() adds a line with a millisecond
+// timestamp to the log and must not be called from interrupts. With USB_CDC set to
+// 0 the console is removed completely and CDC_log() calls compile to nothing.
+//
+// The following must be defined in config.h:
+// USB_CDC              - console enabled (needs USB_MIDI 0 and XRAM_LOC 0x01A0)
+
+#pragma once
+#include <stdint.h>
+#include "config.h"
+
+#if USB_CDC
+
+#define CDC_INTERFACE       2               // number of communication interface
+
+void CDC_init(void);                        // log reset cause (after TIM_init)
+void CDC_process(void);                     // handle console (call in main loop)
+void CDC_log(__code char* str);             // add timestamped line to log
+void CDC_print(__code char* str);           // write string to console
+void CDC_printNum(uint16_t value);          // write decimal number to console
+
+extern volatile __bit CDC_writeBusyFlag;    // EP4 upload busy flag
+void CDC_setup(void);                       // enable EP2 IN and EP4 (USB init)
+void CDC_reset(void);                       // reset endpoints (USB bus reset)
+uint8_t CDC_CTRL_request(void);             // CDC class request (SETUP stage)
+uint8_t CDC_CTRL_OUT(void);                 // CDC class request (data stage)
+void CDC_CTRL_cancel(void);                 // drop pending data stage (new SETUP)
+void CDC_upload(void);                      // upload next packet (IE_USB = 0)
+
+#else
+
+#define CDC_log(str)                        // removed with the console
+
+#endif
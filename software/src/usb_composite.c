@@ -2,38 +2,48 @@
 // USB HID Composite Device Functions for CH551, CH552 and CH554
 // ===================================================================================
 
+#include "ch554.h"
 #include "usb_composite.h"
 #include "usb_hid.h"
 #include "usb_handler.h"
+#include "usb_cdc.h"
+#include "usb_rawhid.h"
+#include "kbd_strings.h"
+#include "kbd_layout.h"
 
-#define KBD_sendReport()    HID_sendReport(KBD_report, sizeof(KBD_report))
-#define CON_sendReport()    HID_sendReport(CON_report, sizeof(CON_report))
-#define JOY_sendReport()    HID_sendReport(JOY_report, sizeof(JOY_report))
+#define KBD_sendReport()    HID_sendState(KBD_report, KBD_last, sizeof(KBD_report))
+#define CON_sendReport()    HID_sendState(CON_report, CON_last, sizeof(CON_report))
+#define SYS_sendReport()    HID_sendState(SYS_report, SYS_last, sizeof(SYS_report))
+#define JOY_sendReport()    HID_sendState(JOY_report, JOY_last, sizeof(JOY_report))
+#define DIAL_sendReport()   HID_sendReport(DIAL_report, sizeof(DIAL_report))
 #define MOUSE_sendReport()  HID_sendReport(MOUSE_report, sizeof(MOUSE_report))
+#define ABS_sendReport()    HID_sendReport(ABS_report, sizeof(ABS_report))
 
 // ===================================================================================
 // HID reports
 // ===================================================================================
 __xdata uint8_t KBD_report[]   = {1,0,0,0,0,0,0,0};
-__xdata uint8_t CON_report[]   = {2,0,0};
-__xdata uint8_t MOUSE_report[] = {3,0,0,0,0};
-__xdata uint8_t JOY_report[]   = {4,0,0,0};
+__xdata uint8_t CON_report[]   = {2,0,0,0,0,0,0,0,0};
+__xdata uint8_t MOUSE_report[] = {3,0,0,0,0,0,0,0};
+__xdata uint8_t JOY_report[]   = {4,0,0,JOY_HAT_CENTER,0,0,0,0};
+__xdata uint8_t DIAL_report[]  = {5,0,0};
+__xdata uint8_t SYS_report[]   = {6,0};
+#if MOUSE_ABSOLUTE
+__xdata uint8_t ABS_report[]   = {7,0,0,0,0,0};
+#endif
 
-// ===================================================================================
-// ASCII to keycode mapping table
-// ===================================================================================
-__code uint8_t KBD_map[128] = {
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2a, 0x2b, 0x28, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x2c, 0x9e, 0xb4, 0xa0, 0xa1, 0xa2, 0xa4, 0x34, 0xa6, 0xa7,
-  0xa5, 0xae, 0x36, 0x2d, 0x37, 0x38, 0x27, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24,
-  0x25, 0x26, 0xb3, 0x33, 0xb6, 0x2e, 0xb7, 0xb8, 0x9f, 0x84, 0x85, 0x86, 0x87, 0x88,
-  0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f, 0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96,
-  0x97, 0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x2f, 0x31, 0x30, 0xa3, 0xad, 0x35, 0x04,
-  0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12,
-  0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0xaf, 0xb1, 0xb0,
-  0xb5, 0x00
-};
+// Last sent state reports (for suppression of duplicates)
+__xdata uint8_t KBD_last[]     = {1,0,0,0,0,0,0,0};
+__xdata uint8_t CON_last[]     = {2,0,0,0,0,0,0,0,0};
+__xdata uint8_t JOY_last[]     = {4,0,0,JOY_HAT_CENTER,0,0,0,0};
+__xdata uint8_t SYS_last[]     = {6,0};
+__xdata uint8_t KBD_code[]     = {1,0,0,0,0,0,0,0}; // KBD_sendCode() report
+
+// Mouse resolution multiplier feature report (set by host if it supports it)
+#define MOUSE_FEATURE_WHEEL   0x01                // high-resolution wheel enabled
+#define MOUSE_FEATURE_PAN     0x04                // high-resolution pan enabled
+__xdata uint8_t MOUSE_feature  = 0;
+int16_t MOUSE_wheelAcc, MOUSE_panAcc;             // fractional notches (low-res mode)
 
 // ===================================================================================
 // Standard Keyboard Functions
@@ -50,6 +60,8 @@ void KBD_press(uint8_t key) {
     key = 0;
   }
   else {                                        // printing key?
+    if(KBD_getExt(key) & KBD_EXT_ALTGR)         // character on AltGr level?
+      KBD_report[1] |= 0x40;                    // add right alt modifier
     key = KBD_map[key];                         // convert ascii to keycode for report
     if(!key) return;                            // no valid key
     if(key & 0x80) {                            // capital letter/shift character?
@@ -84,6 +96,8 @@ void KBD_release(uint8_t key) {
     key = 0;
   }
   else {                                        // printing key?
+    if(KBD_getExt(key) & KBD_EXT_ALTGR)         // character on AltGr level?
+      KBD_report[1] &= ~0x40;                   // remove right alt modifier
     key = KBD_map[key];                         // convert ascii to keycode for report
     if(!key) return;                            // no valid key
     if(key & 0x80) {                            // capital letter/shift character?
@@ -103,6 +117,10 @@ void KBD_release(uint8_t key) {
 void KBD_type(uint8_t key) {
   KBD_press(key);
   KBD_release(key);
+  if(key < 128 && (KBD_getExt(key) & KBD_EXT_DEAD)) { // dead key on this layout?
+    KBD_press(' ');                             // space types the character itself
+    KBD_release(' ');                           // (no recursion, not reentrant)
+  }
 }
 
 // Release all keys on keyboard
@@ -117,26 +135,151 @@ void KBD_print(char* str) {
   while(*str) KBD_type(*str++);
 }
 
+// Type keycode with additional modifiers (no conversion)
+void KBD_typeCode(uint8_t mod, uint8_t key) {
+  uint8_t i, last = KBD_report[1];
+  KBD_report[1] |= mod;                         // add modifiers
+  for(i=3; i<8; i++) {
+    if(!KBD_report[i]) {                        // empty slot?
+      KBD_report[i] = key;                      // insert key
+      break;
+    }
+  }
+  KBD_sendReport();                             // press
+  KBD_report[1] = last;                         // restore modifiers
+  if(i < 8) KBD_report[i] = 0;                  // delete key
+  KBD_sendReport();                             // release
+}
+
+// Send report with only the given modifiers and keycode (0: no key), held keys
+// stay in KBD_report and are sent again by KBD_restore()
+void KBD_sendCode(uint8_t mod, uint8_t key) {
+  KBD_code[1] = mod;
+  KBD_code[3] = key;
+  HID_sendState(KBD_code, KBD_last, sizeof(KBD_code));
+}
+
+// Send held keys again after KBD_sendCode() sequence
+void KBD_restore(void) {
+  KBD_sendReport();
+}
+
+// Type pre-encoded string (see tools/kbdstr.py for the stream format)
+void KBD_play(__code uint8_t* str) {
+  __code uint8_t* ret = 0;                      // return address of fragment call
+  uint8_t op, mod = 0, saved = 0;
+  while(1) {
+    op = *str++;
+    switch(op) {
+      case KBD_STR_END:
+        if(!ret) return;                        // end of string
+        str = ret;                              // return from fragment
+        ret = 0;
+        mod = saved;
+        break;
+      case KBD_STR_MOD:
+        mod = *str++;
+        break;
+      case KBD_STR_REPEAT:
+        for(op = *str++; op; op--) KBD_typeCode(mod, *str);
+        str++;
+        break;
+      case KBD_STR_CALL:
+        ret   = str + 2;
+        saved = mod;
+        mod   = 0;
+        str   = KBD_strings + (str[0] | (uint16_t)str[1] << 8);
+        break;
+      case KBD_STR_ONCE:
+        KBD_typeCode(str[0], str[1]);
+        str += 2;
+        break;
+      default:
+        KBD_typeCode(mod, op);
+        break;
+    }
+  }
+}
+
+// ===================================================================================
+// Keyboard LED State
+// ===================================================================================
+
+uint8_t KBD_ledState = 0;                       // LED state of last KBD_ledEvent()
+
+// Take over LED state set by the host, return 1 if it has changed since last call
+__bit KBD_ledEvent(void) {
+  if(!HID_ledChanged) return 0;                 // no change
+  HID_ledChanged = 0;                           // clear flag before reading state,
+  KBD_ledState = HID_ledState;                  // so a later change is not missed
+  return 1;
+}
+
 // ===================================================================================
 // Consumer Multimedia Keyboard Functions
 // ===================================================================================
 
-// Press a consumer key on keyboard
-void CON_press(uint8_t key) {
-  CON_report[1] = key;
-  CON_sendReport();                             // send report
+// Press a consumer key on keyboard (up to 4 keys at the same time)
+void CON_press(uint16_t key) {
+  uint8_t i;
+  if(!key) return;
+  for(i=1; i<9; i+=2) {                         // 4 slots of 16-bit usages
+    if(CON_report[i] == (uint8_t)key && CON_report[i+1] == (uint8_t)(key >> 8))
+      return;                                   // return if already in report
+  }
+  for(i=1; i<9; i+=2) {
+    if(!CON_report[i] && !CON_report[i+1]) {    // empty slot?
+      CON_report[i]   = key;                    // insert key (little endian)
+      CON_report[i+1] = key >> 8;
+      CON_sendReport();                         // send report
+      break;
+    }
+  }
 }
 
 // Release a consumer key on keyboard
-void CON_release(void) {
-  CON_report[1] = 0;
-  CON_sendReport();
+void CON_release(uint16_t key) {
+  uint8_t i;
+  for(i=1; i<9; i+=2) {
+    if(CON_report[i] == (uint8_t)key && CON_report[i+1] == (uint8_t)(key >> 8))
+      CON_report[i] = CON_report[i+1] = 0;      // delete key in report
+  }
+  CON_sendReport();                             // send report
+}
+
+// Release all consumer keys on keyboard
+void CON_releaseAll(void) {
+  uint8_t i;
+  for(i=8; i; i--) CON_report[i] = 0;           // delete all keys in report
+  CON_sendReport();                             // send report
 }
 
 // Press and release a consumer key on keyboard
-void CON_type(uint8_t key) {
+void CON_type(uint16_t key) {
   CON_press(key);
-  CON_release();
+  CON_release(key);
+}
+
+// ===================================================================================
+// System Control Functions
+// ===================================================================================
+
+// Press a system control key (wakes up the host if it is suspended)
+void SYS_press(uint8_t key) {
+  SYS_report[1] = key;
+  SYS_sendReport();                             // send report
+}
+
+// Release system control key
+void SYS_release(void) {
+  SYS_report[1] = 0;
+  SYS_sendReport();
+}
+
+// Press and release a system control key
+void SYS_type(uint8_t key) {
+  SYS_press(key);
+  SYS_release();
 }
 
 // ===================================================================================
@@ -156,40 +299,315 @@ void MOUSE_release(uint8_t buttons) {
 }
 
 // Move mouse pointer
-void MOUSE_move(int8_t xrel, int8_t yrel) {
+void MOUSE_move(int16_t xrel, int16_t yrel) {
   MOUSE_report[2] = (uint8_t)xrel;              // set relative x-movement
-  MOUSE_report[3] = (uint8_t)yrel;              // set relative y-movement
+  MOUSE_report[3] = (uint8_t)(xrel >> 8);
+  MOUSE_report[4] = (uint8_t)yrel;              // set relative y-movement
+  MOUSE_report[5] = (uint8_t)(yrel >> 8);
   MOUSE_sendReport();                           // send HID report
   MOUSE_report[2] = 0;                          // reset movements
   MOUSE_report[3] = 0;
+  MOUSE_report[4] = 0;
+  MOUSE_report[5] = 0;
 }
 
-// Move mouse wheel
-void MOUSE_wheel(int8_t rel) {
-  MOUSE_report[4] = (uint8_t)rel;               // set relative wheel movement
+#if MOUSE_ABSOLUTE
+// Move mouse pointer to absolute position (0..32767 for the whole screen width/height)
+void MOUSE_moveTo(uint16_t x, uint16_t y) {
+  ABS_report[1] = MOUSE_report[1];              // same buttons as relative mouse
+  ABS_report[2] = (uint8_t)x;                   // set x-position
+  ABS_report[3] = (uint8_t)(x >> 8);
+  ABS_report[4] = (uint8_t)y;                   // set y-position
+  ABS_report[5] = (uint8_t)(y >> 8);
+  ABS_sendReport();                             // send HID report
+}
+#endif
+
+// Convert notches to wheel units according to resolution multiplier
+int8_t MOUSE_notches(int8_t rel, uint8_t hires) {
+  if(!hires) return rel;                        // one unit per notch
+  if(rel >  127 / MOUSE_WHEEL_RES) rel =  127 / MOUSE_WHEEL_RES;
+  if(rel < -127 / MOUSE_WHEEL_RES) rel = -127 / MOUSE_WHEEL_RES;
+  return rel * MOUSE_WHEEL_RES;                 // MOUSE_WHEEL_RES units per notch
+}
+
+// Send wheel and pan movements
+void MOUSE_sendWheel(int8_t vrel, int8_t hrel) {
+  MOUSE_report[6] = (uint8_t)vrel;              // set relative wheel movement
+  MOUSE_report[7] = (uint8_t)hrel;              // set relative pan movement
   MOUSE_sendReport();                           // send HID report
-  MOUSE_report[4] = 0;                          // reset movements
+  MOUSE_report[6] = 0;                          // reset movements
+  MOUSE_report[7] = 0;
+}
+
+// Move mouse wheel (in notches)
+void MOUSE_wheel(int8_t rel) {
+  MOUSE_sendWheel(MOUSE_notches(rel, MOUSE_feature & MOUSE_FEATURE_WHEEL), 0);
+}
+
+// Move horizontal mouse wheel (in notches)
+void MOUSE_pan(int8_t rel) {
+  MOUSE_sendWheel(0, MOUSE_notches(rel, MOUSE_feature & MOUSE_FEATURE_PAN));
+}
+
+// Scroll wheel and pan in fractions of a notch (1/MOUSE_WHEEL_RES);
+// if the host has not enabled high-resolution scrolling, fractions are accumulated
+// here and only whole notches are sent
+void MOUSE_scroll(int8_t vrel, int8_t hrel) {
+  if(!(MOUSE_feature & MOUSE_FEATURE_WHEEL)) {
+    MOUSE_wheelAcc += vrel;
+    vrel = MOUSE_wheelAcc / MOUSE_WHEEL_RES;
+    MOUSE_wheelAcc -= (int16_t)vrel * MOUSE_WHEEL_RES;
+  }
+  if(!(MOUSE_feature & MOUSE_FEATURE_PAN)) {
+    MOUSE_panAcc += hrel;
+    hrel = MOUSE_panAcc / MOUSE_WHEEL_RES;
+    MOUSE_panAcc -= (int16_t)hrel * MOUSE_WHEEL_RES;
+  }
+  if(vrel || hrel) MOUSE_sendWheel(vrel, hrel); // send only if something moved
 }
 
 // ===================================================================================
 // Joystick Functions
 // ===================================================================================
 
+// All joystick reports are state reports, they are only sent if something changed
+
 // Press joystick button(s)
-void JOY_press(uint8_t buttons) {
-  JOY_report[1] |= buttons;                     // press button(s)
+void JOY_press(uint16_t buttons) {
+  JOY_report[1] |= (uint8_t)buttons;            // press button(s)
+  JOY_report[2] |= (uint8_t)(buttons >> 8);
   JOY_sendReport();                             // send HID report
 }
 
 // Release joystick button(s)
-void JOY_release(uint8_t buttons) {
-  JOY_report[1] &= ~buttons;                    // release button(s)
+void JOY_release(uint16_t buttons) {
+  JOY_report[1] &= ~(uint8_t)buttons;           // release button(s)
+  JOY_report[2] &= ~(uint8_t)(buttons >> 8);
+  JOY_sendReport();                             // send HID report
+}
+
+// Set hat switch direction (JOY_HAT_UP .. JOY_HAT_UP_LEFT or JOY_HAT_CENTER)
+void JOY_hat(uint8_t dir) {
+  JOY_report[3] = dir;
   JOY_sendReport();                             // send HID report
 }
 
 // Move joystick
 void JOY_move(int8_t xrel, int8_t yrel) {
-  JOY_report[2] = (uint8_t)xrel;                // set x-movement
-  JOY_report[3] = (uint8_t)yrel;                // set y-movement
+  JOY_report[4] = (uint8_t)xrel;                // set x-movement
+  JOY_report[5] = (uint8_t)yrel;                // set y-movement
   JOY_sendReport();                             // send HID report
 }
+
+// Turn dial axis by rel steps, the position is kept and limited to 0..255
+void JOY_dial(int8_t rel) {
+  int16_t pos = JOY_report[6] + rel;
+  if(pos < 0)   pos = 0;
+  if(pos > 255) pos = 255;
+  JOY_report[6] = pos;
+  JOY_sendReport();                             // send HID report
+}
+
+// Set slider axis position (0..255)
+void JOY_slider(uint8_t pos) {
+  JOY_report[7] = pos;
+  JOY_sendReport();                             // send HID report
+}
+
+// ===================================================================================
+// Radial Controller Functions
+// ===================================================================================
+
+int16_t DIAL_acc;                               // accumulated rotation not yet sent
+
+// Send dial report with button state and rotation
+void DIAL_send(int16_t rel) {
+  DIAL_report[1] = (DIAL_report[1] & 1) | ((uint8_t)rel << 1);  // button + dial bits 0..6
+  DIAL_report[2] = (uint8_t)(rel >> 7);                         // dial bits 7..14
+  DIAL_sendReport();                            // send HID report
+  DIAL_report[1] &= 1;                          // reset rotation
+  DIAL_report[2]  = 0;
+}
+
+// Press radial controller button
+void DIAL_press(void) {
+  DIAL_report[1] |= 1;
+  DIAL_send(0);
+}
+
+// Release radial controller button
+void DIAL_release(void) {
+  DIAL_report[1] &= ~1;
+  DIAL_send(0);
+}
+
+// Rotate dial; steps are accumulated while the endpoint is busy
+void DIAL_rotate(int16_t rel) {
+  DIAL_acc += rel;
+  DIAL_update();
+}
+
+// Send accumulated rotation if endpoint is ready
+void DIAL_update(void) {
+  int16_t rel = DIAL_acc;
+  if(!rel || HID_EP1_writeBusyFlag) return;     // nothing to send or busy
+  if(rel >  3600) rel =  3600;                  // limit to logical range
+  if(rel < -3600) rel = -3600;
+  DIAL_acc -= rel;
+  DIAL_send(rel);
+}
+
+// ===================================================================================
+// State Report Maintenance
+// ===================================================================================
+
+// Forget last sent state reports after a bus reset (the host assumes all released
+// then, held keys are reported again) and repeat state reports whose idle period
+// has elapsed
+void HID_update(void) {
+  uint8_t i;
+  if(HID_resetFlag) {
+    HID_resetFlag = 0;
+    for(i=1; i<sizeof(KBD_last); i++) KBD_last[i] = 0;
+    for(i=1; i<sizeof(CON_last); i++) CON_last[i] = 0;
+    for(i=1; i<sizeof(JOY_last); i++) JOY_last[i] = 0;
+    JOY_last[3] = JOY_HAT_CENTER;
+    SYS_last[1] = 0;
+  }
+  else if(!HID_idleActive || !USB_configured()) return;
+  KBD_sendReport();                             // each one is only sent if it
+  CON_sendReport();                             // changed or its idle period
+  SYS_sendReport();                             // has elapsed
+  JOY_sendReport();
+}
+
+// ===================================================================================
+// HID Class Requests
+// ===================================================================================
+
+uint8_t HID_setReportType;                      // type of pending SET_REPORT
+uint8_t HID_setReportID;                        // report ID of pending SET_REPORT
+
+// Get input report by ID, return length
+uint8_t HID_getInputReport(uint8_t id, __xdata uint8_t** buf) {
+  switch(id) {
+    case 0:                                     // boot protocol (no report IDs)
+    case 1: *buf = KBD_report;   return sizeof(KBD_report);
+    case 2: *buf = CON_report;   return sizeof(CON_report);
+    case 3: *buf = MOUSE_report; return sizeof(MOUSE_report);
+    case 4: *buf = JOY_report;   return sizeof(JOY_report);
+    case 5: *buf = DIAL_report;  return sizeof(DIAL_report);
+    case 6: *buf = SYS_report;   return sizeof(SYS_report);
+    #if MOUSE_ABSOLUTE
+    case 7: *buf = ABS_report;   return sizeof(ABS_report);
+    #endif
+    default:                     return 0;
+  }
+}
+
+// Handle HID class request (SETUP stage), return length of data or 0xFF to stall
+uint8_t HID_CTRL_request(void) {
+  uint8_t i, len;
+  __xdata uint8_t* buf;
+  #if USB_WEBUSB
+  if((USB_setupBuf->bRequestType & USB_REQ_TYP_MASK) == USB_REQ_TYP_VENDOR
+    && USB_setupBuf->wIndexL == USB_VENDOR_INTERFACE) return RAW_CTRL_request();
+  #endif
+  if((USB_setupBuf->bRequestType & USB_REQ_TYP_MASK) != USB_REQ_TYP_CLASS) return 0xFF;
+  #if USB_CDC
+  if(USB_setupBuf->wIndexL == CDC_INTERFACE) return CDC_CTRL_request();
+  #endif
+  if(USB_setupBuf->wIndexL) return(SetupReq == HID_SET_IDLE ? 0 : 0xFF);  // Raw HID
+  switch(SetupReq) {
+    case HID_GET_REPORT:
+      switch(USB_setupBuf->wValueH) {
+        case HID_REPORT_TYP_INPUT:              // current state of input report
+          len = HID_getInputReport(USB_setupBuf->wValueL, &buf);
+          if(!len) return 0xFF;
+          if(!HID_protocol) {                   // boot report without ID, 8 bytes
+            for(i=0; i<8; i++) EP0_buffer[i] = (i < len - 1) ? buf[i + 1] : 0;
+            len = 8;
+          }
+          else for(i=0; i<len; i++) EP0_buffer[i] = buf[i];
+          break;
+        case HID_REPORT_TYP_OUTPUT:             // keyboard LED state
+          EP0_buffer[0] = 1;
+          EP0_buffer[1] = HID_ledState;
+          len = 2;
+          break;
+        case HID_REPORT_TYP_FEATURE:            // mouse resolution multiplier
+          if(USB_setupBuf->wValueL != 3) return 0xFF;
+          EP0_buffer[0] = 3;
+          EP0_buffer[1] = MOUSE_feature;
+          len = 2;
+          break;
+        default:
+          return 0xFF;
+      }
+      return(SetupLen < len ? SetupLen : len);
+
+    case HID_SET_REPORT:
+      HID_setReportType = USB_setupBuf->wValueH;
+      HID_setReportID   = USB_setupBuf->wValueL;
+      if(HID_setReportType == HID_REPORT_TYP_OUTPUT && HID_setReportID <= 1
+        || HID_setReportType == HID_REPORT_TYP_FEATURE && HID_setReportID == 3) {
+        if(!SetupLen) HID_setReportType = 0;    // no data stage follows
+        return 0;
+      }
+      HID_setReportType = 0;
+      return 0xFF;
+
+    case HID_GET_IDLE:
+      if(USB_setupBuf->wValueL >= HID_REPORT_IDS) return 0xFF;
+      EP0_buffer[0] = HID_idleRate[USB_setupBuf->wValueL];
+      return(SetupLen ? 1 : 0);
+
+    case HID_SET_IDLE:                          // duration in 4ms units (0: infinite)
+      if(USB_setupBuf->wValueL >= HID_REPORT_IDS) return 0xFF;
+      HID_setIdle(USB_setupBuf->wValueL, USB_setupBuf->wValueH);
+      return 0;
+
+    case HID_GET_PROTOCOL:
+      EP0_buffer[0] = HID_protocol;
+      return(SetupLen ? 1 : 0);
+
+    case HID_SET_PROTOCOL:
+      if(USB_setupBuf->wValueL > 1) return 0xFF;
+      HID_protocol = USB_setupBuf->wValueL;     // 0: boot, 1: report protocol
+      return 0;
+
+    default:
+      return 0xFF;                              // request not supported
+  }
+}
+
+// Drop data stages still pending when a new SETUP aborts the control transfer
+void HID_CTRL_cancel(void) {
+  HID_setReportType = 0;
+  #if USB_CDC
+  CDC_CTRL_cancel();
+  #endif
+  #if USB_WEBUSB
+  RAW_CTRL_cancel();
+  #endif
+}
+
+// Handle data stage of HID class request, return USB_CTRL_OUT_DONE if it was consumed
+uint8_t HID_CTRL_OUT(void) {
+  #if USB_CDC
+  if(CDC_CTRL_OUT()) return USB_CTRL_OUT_DONE;  // SET_LINE_CODING data
+  #endif
+  #if USB_WEBUSB
+  if(RAW_CTRL_OUT()) return USB_CTRL_OUT_HOLD;  // Raw command, status after execution
+  #endif
+  if(!HID_setReportType) return USB_CTRL_OUT_NONE; // no SET_REPORT pending
+  if(HID_setReportType == HID_REPORT_TYP_FEATURE) {
+    if(USB_RX_LEN >= 2) MOUSE_feature = EP0_buffer[1];
+  }
+  else {                                        // keyboard LEDs, with or without ID
+    if(USB_RX_LEN) HID_setLedState(EP0_buffer[USB_RX_LEN - 1]);
+  }
+  HID_setReportType = 0;
+  return USB_CTRL_OUT_DONE;
+}
@@ -5,6 +5,7 @@
 #pragma once
 #include <stdint.h>
 #include "usb_hid.h"
+#include "config.h"
 
 // Functions
 void KBD_press(uint8_t key);                // press a key on keyboard
@@ -12,22 +13,50 @@ void KBD_release(uint8_t key);              // release a key on keyboard
 void KBD_type(uint8_t key);                 // press and release a key on keyboard
 void KBD_releaseAll(void);                  // release all keys on keyboard
 void KBD_print(char* str);                  // type some text on the keyboard
+void KBD_play(__code uint8_t* str);         // type pre-encoded string (kbd_strings.h)
+void KBD_typeCode(uint8_t mod, uint8_t key);// type HID keycode with modifiers
+void KBD_sendCode(uint8_t mod, uint8_t key);// send report with only this keycode
+void KBD_restore(void);                     // send held keys again after KBD_sendCode()
 
-void CON_press(uint8_t key);                // press a consumer key on keyboard
-void CON_release(void);                     // release consumer key on keyboard
-void CON_type(uint8_t key);                 // press and release a consumer key
+void CON_press(uint16_t key);               // press a consumer key (up to 4 at once)
+void CON_release(uint16_t key);             // release a consumer key on keyboard
+void CON_releaseAll(void);                  // release all consumer keys
+void CON_type(uint16_t key);                // press and release a consumer key
+
+void SYS_press(uint8_t key);                // press a system control key
+void SYS_release(void);                     // release system control key
+void SYS_type(uint8_t key);                 // press and release a system control key
 
 void MOUSE_press(uint8_t buttons);          // press mouse button(s)
 void MOUSE_release(uint8_t buttons);        // release mouse button(s)
-void MOUSE_move(int8_t xrel, int8_t yrel);  // move mouse pointer (relative)
-void MOUSE_wheel(int8_t rel);               // move mouse wheel (relative)
+void MOUSE_move(int16_t xrel, int16_t yrel);// move mouse pointer (relative)
+#if MOUSE_ABSOLUTE
+void MOUSE_moveTo(uint16_t x, uint16_t y);  // move to absolute position (0..32767)
+#endif
+void MOUSE_wheel(int8_t rel);               // move mouse wheel (relative, in notches)
+void MOUSE_pan(int8_t rel);                 // move horizontal wheel (relative, in notches)
+void MOUSE_scroll(int8_t vrel, int8_t hrel);// scroll in 1/MOUSE_WHEEL_RES notch units
 
-void JOY_press(uint8_t buttons);            // press joystick button(s)
-void JOY_release(uint8_t buttons);          // release joystick button(s)
+void JOY_press(uint16_t buttons);           // press joystick button(s) 1..16
+void JOY_release(uint16_t buttons);         // release joystick button(s)
+void JOY_hat(uint8_t dir);                  // set hat switch direction
 void JOY_move(int8_t xrel, int8_t yrel);    // move joystick
+void JOY_dial(int8_t rel);                  // turn dial axis (position 0..255 is kept)
+void JOY_slider(uint8_t pos);               // set slider axis (0..255)
 
 #define MOUSE_wheel_up()        MOUSE_wheel( 1)
 #define MOUSE_wheel_down()      MOUSE_wheel(-1)
+#define MOUSE_pan_right()       MOUSE_pan( 1)
+#define MOUSE_pan_left()        MOUSE_pan(-1)
+
+void DIAL_press(void);                      // press radial controller button
+void DIAL_release(void);                    // release radial controller button
+void DIAL_rotate(int16_t rel);              // rotate dial (in 0.1 degree units)
+void DIAL_update(void);                     // send accumulated rotation (call in loop)
+void HID_update(void);                      // repeat/restore state reports (call in loop)
+
+#define DIAL_cw()               DIAL_rotate( DIAL_STEP)
+#define DIAL_ccw()              DIAL_rotate(-DIAL_STEP)
 
 #define JOY_center()            JOY_move(   0,   0)
 #define JOY_up()                JOY_move(   0,-127)
@@ -35,14 +64,34 @@ void JOY_move(int8_t xrel, int8_t yrel);    // move joystick
 #define JOY_left()              JOY_move(-127,   0)
 #define JOY_right()             JOY_move( 127,   0)
 
-// Keyboard LED states
-#define KBD_getState()          (EP2_buffer[0]) 
+// Joystick hat switch directions
+#define JOY_HAT_UP              0
+#define JOY_HAT_UP_RIGHT        1
+#define JOY_HAT_RIGHT           2
+#define JOY_HAT_DOWN_RIGHT      3
+#define JOY_HAT_DOWN            4
+#define JOY_HAT_DOWN_LEFT       5
+#define JOY_HAT_LEFT            6
+#define JOY_HAT_UP_LEFT         7
+#define JOY_HAT_CENTER          8           // null state
+
+// Keyboard LED states (snapshot taken by KBD_ledEvent())
+__bit KBD_ledEvent(void);                   // take LED state, return 1 if it changed
+extern uint8_t KBD_ledState;                // LED state of last KBD_ledEvent()
+#define KBD_getState()          (KBD_ledState)
 #define KBD_NUM_LOCK_state      (KBD_getState() & 1)
 #define KBD_CAPS_LOCK_state     ((KBD_getState() >> 1) & 1)
 #define KBD_SCROLL_LOCK_state   ((KBD_getState() >> 2) & 1)
 #define KBD_COMPOSE_state       ((KBD_getState() >> 3) & 1)
 #define KBD_KANA_state          ((KBD_getState() >> 4) & 1)
 
+// Pre-encoded string stream opcodes (generated by tools/kbdstr.py)
+#define KBD_STR_END             0x00        // end of string / return from fragment
+#define KBD_STR_MOD             0xF0        // set modifiers
+#define KBD_STR_REPEAT          0xF1        // type keycode n times
+#define KBD_STR_CALL            0xF2        // call fragment at 16-bit offset
+#define KBD_STR_ONCE            0xF3        // type keycode once with modifiers
+
 // Modifier keys
 #define KBD_KEY_LEFT_CTRL       0x80
 #define KBD_KEY_LEFT_SHIFT      0x81
@@ -95,10 +144,6 @@ void JOY_move(int8_t xrel, int8_t yrel);    // move joystick
 #define KBD_KEY_F24             0xFB
 
 // Consumer Keyboard Keycodes
-#define CON_SYS_POWER           0x30
-#define CON_SYS_RESET           0x31
-#define CON_SYS_SLEEP           0x32
-
 #define CON_VOL_MUTE            0xE2
 #define CON_VOL_UP              0xE9
 #define CON_VOL_DOWN            0xEA
@@ -124,6 +169,30 @@ void JOY_move(int8_t xrel, int8_t yrel);    // move joystick
 #define CON_MENU_INCR           0x47
 #define CON_MENU_DECR           0x48
 
+#define CON_AL_CONFIG           0x183
+#define CON_AL_EMAIL            0x18A
+#define CON_AL_CALCULATOR       0x192
+#define CON_AL_BROWSER          0x196
+#define CON_AL_LOCK             0x19E
+#define CON_AC_SEARCH           0x221
+#define CON_AC_HOME             0x223
+#define CON_AC_BACK             0x224
+#define CON_AC_FORWARD          0x225
+#define CON_AC_REFRESH          0x227
+#define CON_AC_ZOOM_IN          0x22D
+#define CON_AC_ZOOM_OUT         0x22E
+
+// System Control Keycodes
+#define SYS_POWER               0x81
+#define SYS_SLEEP               0x82
+#define SYS_WAKE                0x83
+#define SYS_COLD_RESTART        0x8E
+#define SYS_WARM_RESTART        0x8F
+#define SYS_HIBERNATE           0xA8
+
+// Radial controller dial step per encoder detent (in 0.1 degree units)
+#define DIAL_STEP               100
+
 // Mouse Buttons
 #define MOUSE_BUTTON_LEFT       0x01
 #define MOUSE_BUTTON_RIGHT      0x02
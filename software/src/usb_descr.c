@@ -3,6 +3,7 @@
 // ===================================================================================
 
 #include "usb_descr.h"
+#include "kbd_layout.h"
 
 // ===================================================================================
 // Device Descriptor
@@ -10,10 +11,20 @@
 __code USB_DEV_DESCR DevDescr = {
   .bLength            = sizeof(DevDescr),       // size of the descriptor in bytes: 18
   .bDescriptorType    = USB_DESCR_TYP_DEVICE,   // device descriptor: 0x01
+  #if USB_WEBUSB
+  .bcdUSB             = 0x0210,                 // USB specification: USB 2.1 (BOS)
+  #else
   .bcdUSB             = 0x0110,                 // USB specification: USB 1.1
+  #endif
+  #if USB_CDC                                   // interface association descriptor
+  .bDeviceClass       = USB_DEV_CLASS_MISC,     // miscellaneous device class (0xEF)
+  .bDeviceSubClass    = 2,                      // common class
+  .bDeviceProtocol    = 1,                      // interface association
+  #else
   .bDeviceClass       = 0,                      // interface will define class
   .bDeviceSubClass    = 0,                      // unused
   .bDeviceProtocol    = 0,                      // unused
+  #endif
   .bMaxPacketSize0    = EP0_SIZE,               // maximum packet size for Endpoint 0
   .idVendor           = USB_VENDOR_ID,          // VID
   .idProduct          = USB_PRODUCT_ID,         // PID
@@ -34,10 +45,10 @@ __code USB_CFG_DESCR_HID CfgDescr = {
     .bLength            = sizeof(USB_CFG_DESCR),  // size of the descriptor in bytes
     .bDescriptorType    = USB_DESCR_TYP_CONFIG,   // configuration descriptor: 0x02
     .wTotalLength       = sizeof(CfgDescr),       // total length in bytes
-    .bNumInterfaces     = 1,                      // number of interfaces: 1
+    .bNumInterfaces     = USB_INTERFACES,         // 2 (+2 MIDI or CDC, +1 vendor)
     .bConfigurationValue= 1,                      // value to select this configuration
     .iConfiguration     = 0,                      // no configuration string descriptor
-    .bmAttributes       = 0x80,                   // attributes = bus powered, no wakeup
+    .bmAttributes       = 0xa0,                   // attributes = bus powered, remote wakeup
     .MaxPower           = USB_MAX_POWER_mA / 2    // in 2mA units
   },
 
@@ -59,7 +70,7 @@ __code USB_CFG_DESCR_HID CfgDescr = {
     .bLength            = sizeof(USB_HID_DESCR),  // size of the descriptor in bytes: 9
     .bDescriptorType    = USB_DESCR_TYP_HID,      // HID descriptor: 0x21
     .bcdHID             = 0x0110,                 // HID class spec version (BCD: 1.1)
-    .bCountryCode       = 33,                     // country code: US
+    .bCountryCode       = KBD_COUNTRY_CODE,       // country code of keyboard layout
     .bNumDescriptors    = 1,                      // number of report descriptors: 1
     .bDescriptorTypeX   = USB_DESCR_TYP_REPORT,   // descriptor type: report (0x22)
     .wDescriptorLength  = sizeof(ReportDescr)     // report descriptor length
@@ -83,6 +94,305 @@ __code USB_CFG_DESCR_HID CfgDescr = {
     .bmAttributes       = USB_ENDP_TYPE_INTER,    // transfer type: interrupt (0x03)
     .wMaxPacketSize     = EP2_SIZE,               // max packet size
     .bInterval          = 10                      // polling intervall in ms
+  },
+
+  // Interface Descriptor: Raw HID (vendor-defined configuration interface)
+  .interface1 = {
+    .bLength            = sizeof(USB_ITF_DESCR),  // size of the descriptor in bytes: 9
+    .bDescriptorType    = USB_DESCR_TYP_INTERF,   // interface descriptor: 0x04
+    .bInterfaceNumber   = 1,                      // number of this interface: 1
+    .bAlternateSetting  = 0,                      // value used to select alternative setting
+    .bNumEndpoints      = 2,                      // number of endpoints used: 2
+    .bInterfaceClass    = USB_DEV_CLASS_HID,      // interface class: HID (0x03)
+    .bInterfaceSubClass = 0,                      // no boot interface
+    .bInterfaceProtocol = 0,                      // none
+    .iInterface         = 0                       // no interface string descriptor
+  },
+
+  // HID Descriptor
+  .hid1 = {
+    .bLength            = sizeof(USB_HID_DESCR),  // size of the descriptor in bytes: 9
+    .bDescriptorType    = USB_DESCR_TYP_HID,      // HID descriptor: 0x21
+    .bcdHID             = 0x0110,                 // HID class spec version (BCD: 1.1)
+    .bCountryCode       = 0,                      // not localized
+    .bNumDescriptors    = 1,                      // number of report descriptors: 1
+    .bDescriptorTypeX   = USB_DESCR_TYP_REPORT,   // descriptor type: report (0x22)
+    .wDescriptorLength  = sizeof(RawReportDescr)  // report descriptor length
+  },
+
+  // Endpoint Descriptor: Endpoint 3 (IN, Interrupt)
+  .ep3IN = {
+    .bLength            = sizeof(USB_ENDP_DESCR), // size of the descriptor in bytes: 7
+    .bDescriptorType    = USB_DESCR_TYP_ENDP,     // endpoint descriptor: 0x05
+    .bEndpointAddress   = USB_ENDP_ADDR_EP3_IN,   // endpoint: 3, direction: IN (0x83)
+    .bmAttributes       = USB_ENDP_TYPE_INTER,    // transfer type: interrupt (0x03)
+    .wMaxPacketSize     = EP3_SIZE,               // max packet size
+    .bInterval          = 1                       // polling intervall in ms
+  },
+
+  // Endpoint Descriptor: Endpoint 3 (OUT, Interrupt)
+  .ep3OUT = {
+    .bLength            = sizeof(USB_ENDP_DESCR), // size of the descriptor in bytes: 7
+    .bDescriptorType    = USB_DESCR_TYP_ENDP,     // endpoint descriptor: 0x05
+    .bEndpointAddress   = USB_ENDP_ADDR_EP3_OUT,  // endpoint: 3, direction: OUT (0x03)
+    .bmAttributes       = USB_ENDP_TYPE_INTER,    // transfer type: interrupt (0x03)
+    .wMaxPacketSize     = EP3_SIZE,               // max packet size
+    .bInterval          = 1                       // polling intervall in ms
+  #if USB_MIDI
+  },
+
+  // Interface Descriptor: Audio Control (required by the MIDI Streaming interface)
+  .interface2 = {
+    .bLength            = sizeof(USB_ITF_DESCR),  // size of the descriptor in bytes: 9
+    .bDescriptorType    = USB_DESCR_TYP_INTERF,   // interface descriptor: 0x04
+    .bInterfaceNumber   = 2,                      // number of this interface: 2
+    .bAlternateSetting  = 0,                      // value used to select alternative setting
+    .bNumEndpoints      = 0,                      // number of endpoints used: 0
+    .bInterfaceClass    = USB_DEV_CLASS_AUDIO,    // interface class: audio (0x01)
+    .bInterfaceSubClass = USB_AUDIO_SUBCLASS_CONTROL, // audio control (0x01)
+    .bInterfaceProtocol = 0,                      // none
+    .iInterface         = 0                       // no interface string descriptor
+  },
+
+  // Class-specific Audio Control Interface Header
+  .acHeader = {
+    .bLength            = sizeof(USB_AC_HEADER_DESCR), // size of the descriptor in bytes: 9
+    .bDescriptorType    = USB_DESCR_TYP_CS_INTF,  // class-specific interface: 0x24
+    .bDescriptorSubtype = USB_MIDI_HEADER,        // header: 0x01
+    .bcdADC             = 0x0100,                 // audio class spec version (BCD: 1.0)
+    .wTotalLength       = sizeof(USB_AC_HEADER_DESCR), // class-specific descriptors
+    .bInCollection      = 1,                      // number of streaming interfaces: 1
+    .baInterfaceNr      = 3                       // MIDI Streaming interface: 3
+  },
+
+  // Interface Descriptor: MIDI Streaming
+  .interface3 = {
+    .bLength            = sizeof(USB_ITF_DESCR),  // size of the descriptor in bytes: 9
+    .bDescriptorType    = USB_DESCR_TYP_INTERF,   // interface descriptor: 0x04
+    .bInterfaceNumber   = 3,                      // number of this interface: 3
+    .bAlternateSetting  = 0,                      // value used to select alternative setting
+    .bNumEndpoints      = 2,                      // number of endpoints used: 2
+    .bInterfaceClass    = USB_DEV_CLASS_AUDIO,    // interface class: audio (0x01)
+    .bInterfaceSubClass = USB_AUDIO_SUBCLASS_MIDI,// MIDI streaming (0x03)
+    .bInterfaceProtocol = 0,                      // none
+    .iInterface         = 0                       // no interface string descriptor
+  },
+
+  // Class-specific MIDI Streaming Interface Header
+  .msHeader = {
+    .bLength            = sizeof(USB_MS_HEADER_DESCR), // size of the descriptor in bytes: 7
+    .bDescriptorType    = USB_DESCR_TYP_CS_INTF,  // class-specific interface: 0x24
+    .bDescriptorSubtype = USB_MIDI_HEADER,        // header: 0x01
+    .bcdMSC             = 0x0100,                 // MIDI class spec version (BCD: 1.0)
+    .wTotalLength       = 65                      // header, jacks and endpoints
+  },
+
+  // MIDI IN Jack: embedded (host -> device)
+  .jackInEmb = {
+    .bLength            = sizeof(USB_MIDI_IN_JACK_DESCR), // size in bytes: 6
+    .bDescriptorType    = USB_DESCR_TYP_CS_INTF,  // class-specific interface: 0x24
+    .bDescriptorSubtype = USB_MIDI_IN_JACK,       // MIDI IN jack: 0x02
+    .bJackType          = USB_MIDI_JACK_EMBEDDED, // embedded
+    .bJackID            = 1,                      // jack ID: 1
+    .iJack              = 0                       // no jack string descriptor
+  },
+
+  // MIDI IN Jack: external (keys and encoder)
+  .jackInExt = {
+    .bLength            = sizeof(USB_MIDI_IN_JACK_DESCR), // size in bytes: 6
+    .bDescriptorType    = USB_DESCR_TYP_CS_INTF,  // class-specific interface: 0x24
+    .bDescriptorSubtype = USB_MIDI_IN_JACK,       // MIDI IN jack: 0x02
+    .bJackType          = USB_MIDI_JACK_EXTERNAL, // external
+    .bJackID            = 2,                      // jack ID: 2
+    .iJack              = 0                       // no jack string descriptor
+  },
+
+  // MIDI OUT Jack: embedded (device -> host), fed by the external IN jack
+  .jackOutEmb = {
+    .bLength            = sizeof(USB_MIDI_OUT_JACK_DESCR), // size in bytes: 9
+    .bDescriptorType    = USB_DESCR_TYP_CS_INTF,  // class-specific interface: 0x24
+    .bDescriptorSubtype = USB_MIDI_OUT_JACK,      // MIDI OUT jack: 0x03
+    .bJackType          = USB_MIDI_JACK_EMBEDDED, // embedded
+    .bJackID            = 3,                      // jack ID: 3
+    .bNrInputPins       = 1,                      // number of input pins: 1
+    .baSourceID         = 2,                      // connected to jack 2
+    .baSourcePin        = 1,                      // output pin 1 of jack 2
+    .iJack              = 0                       // no jack string descriptor
+  },
+
+  // MIDI OUT Jack: external, fed by the embedded IN jack
+  .jackOutExt = {
+    .bLength            = sizeof(USB_MIDI_OUT_JACK_DESCR), // size in bytes: 9
+    .bDescriptorType    = USB_DESCR_TYP_CS_INTF,  // class-specific interface: 0x24
+    .bDescriptorSubtype = USB_MIDI_OUT_JACK,      // MIDI OUT jack: 0x03
+    .bJackType          = USB_MIDI_JACK_EXTERNAL, // external
+    .bJackID            = 4,                      // jack ID: 4
+    .bNrInputPins       = 1,                      // number of input pins: 1
+    .baSourceID         = 1,                      // connected to jack 1
+    .baSourcePin        = 1,                      // output pin 1 of jack 1
+    .iJack              = 0                       // no jack string descriptor
+  },
+
+  // Endpoint Descriptor: Endpoint 4 (OUT, Bulk)
+  .ep4OUT = {
+    .bLength            = sizeof(USB_AUDIO_ENDP_DESCR), // size in bytes: 9
+    .bDescriptorType    = USB_DESCR_TYP_ENDP,     // endpoint descriptor: 0x05
+    .bEndpointAddress   = USB_ENDP_ADDR_EP4_OUT,  // endpoint: 4, direction: OUT (0x04)
+    .bmAttributes       = USB_ENDP_TYPE_BULK,     // transfer type: bulk (0x02)
+    .wMaxPacketSize     = EP4_SIZE,               // max packet size
+    .bInterval          = 0,                      // ignored for bulk
+    .bRefresh           = 0,                      // unused
+    .bSynchAddress      = 0                       // unused
+  },
+
+  // Class-specific MIDI Streaming Endpoint Descriptor
+  .ms4OUT = {
+    .bLength            = sizeof(USB_MS_ENDP_DESCR), // size in bytes: 5
+    .bDescriptorType    = USB_DESCR_TYP_CS_ENDP,  // class-specific endpoint: 0x25
+    .bDescriptorSubtype = USB_MIDI_GENERAL,       // general: 0x01
+    .bNumEmbMIDIJack    = 1,                      // number of embedded jacks: 1
+    .baAssocJackID      = 1                       // embedded IN jack 1
+  },
+
+  // Endpoint Descriptor: Endpoint 4 (IN, Bulk)
+  .ep4IN = {
+    .bLength            = sizeof(USB_AUDIO_ENDP_DESCR), // size in bytes: 9
+    .bDescriptorType    = USB_DESCR_TYP_ENDP,     // endpoint descriptor: 0x05
+    .bEndpointAddress   = USB_ENDP_ADDR_EP4_IN,   // endpoint: 4, direction: IN (0x84)
+    .bmAttributes       = USB_ENDP_TYPE_BULK,     // transfer type: bulk (0x02)
+    .wMaxPacketSize     = EP4_SIZE,               // max packet size
+    .bInterval          = 0,                      // ignored for bulk
+    .bRefresh           = 0,                      // unused
+    .bSynchAddress      = 0                       // unused
+  },
+
+  // Class-specific MIDI Streaming Endpoint Descriptor
+  .ms4IN = {
+    .bLength            = sizeof(USB_MS_ENDP_DESCR), // size in bytes: 5
+    .bDescriptorType    = USB_DESCR_TYP_CS_ENDP,  // class-specific endpoint: 0x25
+    .bDescriptorSubtype = USB_MIDI_GENERAL,       // general: 0x01
+    .bNumEmbMIDIJack    = 1,                      // number of embedded jacks: 1
+    .baAssocJackID      = 3                       // embedded OUT jack 3
+  #endif
+  #if USB_CDC
+  },
+
+  // Interface Association Descriptor: CDC-ACM console (interfaces 2 and 3)
+  .association2 = {
+    .bLength            = sizeof(USB_IAD_DESCR),  // size of the descriptor in bytes: 8
+    .bDescriptorType    = USB_DESCR_TYP_IAD,      // interface association: 0x0B
+    .bFirstInterface    = 2,                      // first interface: 2
+    .bInterfaceCount    = 2,                      // number of interfaces: 2
+    .bFunctionClass     = USB_DEV_CLASS_COMM,     // function class: CDC (0x02)
+    .bFunctionSubClass  = USB_CDC_SUBCLASS_ACM,   // abstract control model (0x02)
+    .bFunctionProtocol  = 0,                      // no AT commands
+    .iFunction          = 0                       // no function string descriptor
+  },
+
+  // Interface Descriptor: CDC Communication
+  .interface2 = {
+    .bLength            = sizeof(USB_ITF_DESCR),  // size of the descriptor in bytes: 9
+    .bDescriptorType    = USB_DESCR_TYP_INTERF,   // interface descriptor: 0x04
+    .bInterfaceNumber   = 2,                      // number of this interface: 2
+    .bAlternateSetting  = 0,                      // value used to select alternative setting
+    .bNumEndpoints      = 1,                      // number of endpoints used: 1
+    .bInterfaceClass    = USB_DEV_CLASS_COMM,     // interface class: CDC (0x02)
+    .bInterfaceSubClass = USB_CDC_SUBCLASS_ACM,   // abstract control model (0x02)
+    .bInterfaceProtocol = 0,                      // no AT commands
+    .iInterface         = 0                       // no interface string descriptor
+  },
+
+  // Functional Descriptor: Header
+  .cdcHeader = {
+    .bLength            = sizeof(USB_CDC_HEADER_DESCR), // size in bytes: 5
+    .bDescriptorType    = USB_DESCR_TYP_CS_INTF,  // class-specific interface: 0x24
+    .bDescriptorSubtype = USB_CDC_HEADER,         // header: 0x00
+    .bcdCDC             = 0x0110                  // CDC spec version (BCD: 1.1)
+  },
+
+  // Functional Descriptor: Call Management
+  .cdcCallMgmt = {
+    .bLength            = sizeof(USB_CDC_CALL_MGMT_DESCR), // size in bytes: 5
+    .bDescriptorType    = USB_DESCR_TYP_CS_INTF,  // class-specific interface: 0x24
+    .bDescriptorSubtype = USB_CDC_CALL_MGMT,      // call management: 0x01
+    .bmCapabilities     = 0,                      // no call management
+    .bDataInterface     = 3                       // data interface: 3
+  },
+
+  // Functional Descriptor: Abstract Control Management
+  .cdcAcm = {
+    .bLength            = sizeof(USB_CDC_ACM_DESCR), // size in bytes: 4
+    .bDescriptorType    = USB_DESCR_TYP_CS_INTF,  // class-specific interface: 0x24
+    .bDescriptorSubtype = USB_CDC_ACM,            // abstract control management: 0x02
+    .bmCapabilities     = 0x02                    // line coding and line state requests
+  },
+
+  // Functional Descriptor: Union
+  .cdcUnion = {
+    .bLength            = sizeof(USB_CDC_UNION_DESCR), // size in bytes: 5
+    .bDescriptorType    = USB_DESCR_TYP_CS_INTF,  // class-specific interface: 0x24
+    .bDescriptorSubtype = USB_CDC_UNION,          // union: 0x06
+    .bMasterInterface   = 2,                      // communication interface: 2
+    .bSlaveInterface0   = 3                       // data interface: 3
+  },
+
+  // Endpoint Descriptor: Endpoint 2 (IN, Interrupt), notifications (never sent)
+  .ep2IN = {
+    .bLength            = sizeof(USB_ENDP_DESCR), // size of the descriptor in bytes: 7
+    .bDescriptorType    = USB_DESCR_TYP_ENDP,     // endpoint descriptor: 0x05
+    .bEndpointAddress   = USB_ENDP_ADDR_EP2_IN,   // endpoint: 2, direction: IN (0x82)
+    .bmAttributes       = USB_ENDP_TYPE_INTER,    // transfer type: interrupt (0x03)
+    .wMaxPacketSize     = EP2_SIZE,               // max packet size
+    .bInterval          = 255                     // polling intervall in ms
+  },
+
+  // Interface Descriptor: CDC Data
+  .interface3 = {
+    .bLength            = sizeof(USB_ITF_DESCR),  // size of the descriptor in bytes: 9
+    .bDescriptorType    = USB_DESCR_TYP_INTERF,   // interface descriptor: 0x04
+    .bInterfaceNumber   = 3,                      // number of this interface: 3
+    .bAlternateSetting  = 0,                      // value used to select alternative setting
+    .bNumEndpoints      = 2,                      // number of endpoints used: 2
+    .bInterfaceClass    = USB_DEV_CLASS_DATA,     // interface class: CDC data (0x0A)
+    .bInterfaceSubClass = 0,                      // unused
+    .bInterfaceProtocol = 0,                      // no specific protocol
+    .iInterface         = 0                       // no interface string descriptor
+  },
+
+  // Endpoint Descriptor: Endpoint 4 (OUT, Bulk)
+  .ep4OUT = {
+    .bLength            = sizeof(USB_ENDP_DESCR), // size of the descriptor in bytes: 7
+    .bDescriptorType    = USB_DESCR_TYP_ENDP,     // endpoint descriptor: 0x05
+    .bEndpointAddress   = USB_ENDP_ADDR_EP4_OUT,  // endpoint: 4, direction: OUT (0x04)
+    .bmAttributes       = USB_ENDP_TYPE_BULK,     // transfer type: bulk (0x02)
+    .wMaxPacketSize     = EP4_SIZE,               // max packet size
+    .bInterval          = 0                       // ignored for bulk
+  },
+
+  // Endpoint Descriptor: Endpoint 4 (IN, Bulk)
+  .ep4IN = {
+    .bLength            = sizeof(USB_ENDP_DESCR), // size of the descriptor in bytes: 7
+    .bDescriptorType    = USB_DESCR_TYP_ENDP,     // endpoint descriptor: 0x05
+    .bEndpointAddress   = USB_ENDP_ADDR_EP4_IN,   // endpoint: 4, direction: IN (0x84)
+    .bmAttributes       = USB_ENDP_TYPE_BULK,     // transfer type: bulk (0x02)
+    .wMaxPacketSize     = EP4_SIZE,               // max packet size
+    .bInterval          = 0                       // ignored for bulk
+  #endif
+  #if USB_WEBUSB
+  },
+
+  // Interface Descriptor: vendor-specific, no endpoints (WebUSB/WinUSB control access)
+  .interfaceVendor = {
+    .bLength            = sizeof(USB_ITF_DESCR),  // size of the descriptor in bytes: 9
+    .bDescriptorType    = USB_DESCR_TYP_INTERF,   // interface descriptor: 0x04
+    .bInterfaceNumber   = USB_VENDOR_INTERFACE,   // number of this interface: 2 or 4
+    .bAlternateSetting  = 0,                      // value used to select alternative setting
+    .bNumEndpoints      = 0,                      // control transfers only
+    .bInterfaceClass    = USB_DEV_CLASS_VENDOR,   // interface class: vendor (0xFF)
+    .bInterfaceSubClass = 0,                      // none
+    .bInterfaceProtocol = 0,                      // none
+    .iInterface         = 0                       // no interface string descriptor
+  #endif
   }
 };
 
@@ -132,15 +442,29 @@ __code uint8_t ReportDescr[] ={
   0xa1, 0x01,           // COLLECTION (Application)
   0x85, 0x02,           //   REPORT_ID (2)
   0x19, 0x00,           //   USAGE_MINIMUM (Unassigned)
-  0x2a, 0x3c, 0x02,     //   USAGE_MAXIMUM (AC Format)
+  0x2a, 0xff, 0x03,     //   USAGE_MAXIMUM (0x3ff)
   0x15, 0x00,           //   LOGICAL_MINIMUM (0)
-  0x26, 0x3c, 0x02,     //   LOGICAL_MAXIMUM (572)
+  0x26, 0xff, 0x03,     //   LOGICAL_MAXIMUM (1023)
   0x75, 0x10,           //   REPORT_SIZE (16)
+  0x95, 0x04,           //   REPORT_COUNT (4)
+  0x81, 0x00,           //   INPUT (Data,Ary,Abs)
+  0xc0,                 // END_COLLECTION
+
+  // System control (power down, sleep, wake up)
+  0x05, 0x01,           // USAGE_PAGE (Generic Desktop)
+  0x09, 0x80,           // USAGE (System Control)
+  0xa1, 0x01,           // COLLECTION (Application)
+  0x85, 0x06,           //   REPORT_ID (6)
+  0x19, 0x00,           //   USAGE_MINIMUM (Undefined)
+  0x29, 0xb7,           //   USAGE_MAXIMUM (System Speaker Mute)
+  0x15, 0x00,           //   LOGICAL_MINIMUM (0)
+  0x26, 0xb7, 0x00,     //   LOGICAL_MAXIMUM (183)
+  0x75, 0x08,           //   REPORT_SIZE (8)
   0x95, 0x01,           //   REPORT_COUNT (1)
-  0x81, 0x00,           //   INPUT (Data,Var,Abs)
+  0x81, 0x00,           //   INPUT (Data,Ary,Abs)
   0xc0,                 // END_COLLECTION
 
-  // Mouse with wheel and 3 buttons
+  // Mouse with high-resolution wheel, horizontal pan and 3 buttons
   0x05, 0x01,           // USAGE_PAGE (Generic Desktop)
   0x09, 0x02,           // USAGE (Mouse)
   0xa1, 0x01,           // COLLECTION (Application)
@@ -161,42 +485,285 @@ __code uint8_t ReportDescr[] ={
   0x05, 0x01,           //     USAGE_PAGE (Generic Desktop)
   0x09, 0x30,           //     USAGE (X)
   0x09, 0x31,           //     USAGE (Y)
-  0x09, 0x38,           //     USAGE (Wheel)
-  0x15, 0x81,           //     LOGICAL_MINIMUM (-127)
-  0x25, 0x7f,           //     LOGICAL_MAXIMUM (127)
-  0x75, 0x08,           //     REPORT_SIZE (8)
-  0x95, 0x03,           //     REPORT_COUNT (3)
+  0x16, 0x01, 0x80,     //     LOGICAL_MINIMUM (-32767)
+  0x26, 0xff, 0x7f,     //     LOGICAL_MAXIMUM (32767)
+  0x75, 0x10,           //     REPORT_SIZE (16)
+  0x95, 0x02,           //     REPORT_COUNT (2)
   0x81, 0x06,           //     INPUT (Data,Var,Rel)
+  0xa1, 0x02,           //     COLLECTION (Logical)
+  0x09, 0x48,           //       USAGE (Resolution Multiplier)
+  0x15, 0x00,           //       LOGICAL_MINIMUM (0)
+  0x25, 0x01,           //       LOGICAL_MAXIMUM (1)
+  0x35, 0x01,           //       PHYSICAL_MINIMUM (1)
+  0x45, MOUSE_WHEEL_RES,//       PHYSICAL_MAXIMUM (MOUSE_WHEEL_RES)
+  0x75, 0x02,           //       REPORT_SIZE (2)
+  0x95, 0x01,           //       REPORT_COUNT (1)
+  0xb1, 0x02,           //       FEATURE (Data,Var,Abs)
+  0x35, 0x00,           //       PHYSICAL_MINIMUM (0)
+  0x45, 0x00,           //       PHYSICAL_MAXIMUM (0)
+  0x09, 0x38,           //       USAGE (Wheel)
+  0x15, 0x81,           //       LOGICAL_MINIMUM (-127)
+  0x25, 0x7f,           //       LOGICAL_MAXIMUM (127)
+  0x75, 0x08,           //       REPORT_SIZE (8)
+  0x95, 0x01,           //       REPORT_COUNT (1)
+  0x81, 0x06,           //       INPUT (Data,Var,Rel)
+  0xc0,                 //     END_COLLECTION
+  0xa1, 0x02,           //     COLLECTION (Logical)
+  0x09, 0x48,           //       USAGE (Resolution Multiplier)
+  0x15, 0x00,           //       LOGICAL_MINIMUM (0)
+  0x25, 0x01,           //       LOGICAL_MAXIMUM (1)
+  0x35, 0x01,           //       PHYSICAL_MINIMUM (1)
+  0x45, MOUSE_WHEEL_RES,//       PHYSICAL_MAXIMUM (MOUSE_WHEEL_RES)
+  0x75, 0x02,           //       REPORT_SIZE (2)
+  0x95, 0x01,           //       REPORT_COUNT (1)
+  0xb1, 0x02,           //       FEATURE (Data,Var,Abs)
+  0x35, 0x00,           //       PHYSICAL_MINIMUM (0)
+  0x45, 0x00,           //       PHYSICAL_MAXIMUM (0)
+  0x05, 0x0c,           //       USAGE_PAGE (Consumer Devices)
+  0x0a, 0x38, 0x02,     //       USAGE (AC Pan)
+  0x15, 0x81,           //       LOGICAL_MINIMUM (-127)
+  0x25, 0x7f,           //       LOGICAL_MAXIMUM (127)
+  0x75, 0x08,           //       REPORT_SIZE (8)
+  0x95, 0x01,           //       REPORT_COUNT (1)
+  0x81, 0x06,           //       INPUT (Data,Var,Rel)
+  0xc0,                 //     END_COLLECTION
+  0x75, 0x04,           //     REPORT_SIZE (4)
+  0x95, 0x01,           //     REPORT_COUNT (1)
+  0xb1, 0x03,           //     FEATURE (Cnst,Var,Abs)
   0xc0,                 //   END_COLLECTION
   0xc0,                 // END_COLLECTION
 
-  // Joystick with 8 buttons
-	0x05, 0x01,           // USAGE_PAGE (Generic Desktop)
-	0x09, 0x05,           // USAGE (Game Pad)
-	0xa1, 0x01,           // COLLECTION (Application)
-	0xa1, 0x00,           //   COLLECTION (Physical)
+  #if MOUSE_ABSOLUTE
+  // Absolute pointer with 3 buttons (0..32767 maps to the whole screen)
+  0x05, 0x01,           // USAGE_PAGE (Generic Desktop)
+  0x09, 0x02,           // USAGE (Mouse)
+  0xa1, 0x01,           // COLLECTION (Application)
+  0x09, 0x01,           //   USAGE (Pointer)
+  0xa1, 0x00,           //   COLLECTION (Physical)
+  0x85, 0x07,           //     REPORT_ID (7)
+  0x05, 0x09,           //     USAGE_PAGE (Button)
+  0x19, 0x01,           //     USAGE_MINIMUM (Button 1)
+  0x29, 0x03,           //     USAGE_MAXIMUM (Button 3)
+  0x15, 0x00,           //     LOGICAL_MINIMUM (0)
+  0x25, 0x01,           //     LOGICAL_MAXIMUM (1)
+  0x75, 0x01,           //     REPORT_SIZE (1)
+  0x95, 0x03,           //     REPORT_COUNT (3)
+  0x81, 0x02,           //     INPUT (Data,Var,Abs)
+  0x75, 0x05,           //     REPORT_SIZE (5)
+  0x95, 0x01,           //     REPORT_COUNT (1)
+  0x81, 0x03,           //     INPUT (Cnst,Var,Abs)
+  0x05, 0x01,           //     USAGE_PAGE (Generic Desktop)
+  0x09, 0x30,           //     USAGE (X)
+  0x09, 0x31,           //     USAGE (Y)
+  0x15, 0x00,           //     LOGICAL_MINIMUM (0)
+  0x26, 0xff, 0x7f,     //     LOGICAL_MAXIMUM (32767)
+  0x75, 0x10,           //     REPORT_SIZE (16)
+  0x95, 0x02,           //     REPORT_COUNT (2)
+  0x81, 0x02,           //     INPUT (Data,Var,Abs)
+  0xc0,                 //   END_COLLECTION
+  0xc0,                 // END_COLLECTION
+  #endif
+
+  // Gamepad with 16 buttons, hat switch, X/Y axes, dial and slider
+  0x05, 0x01,           // USAGE_PAGE (Generic Desktop)
+  0x09, 0x05,           // USAGE (Game Pad)
+  0xa1, 0x01,           // COLLECTION (Application)
+  0xa1, 0x00,           //   COLLECTION (Physical)
   0x85, 0x04,           //     REPORT_ID (4)
-	0x05, 0x09,           //     USAGE_PAGE (Button)
-	0x19, 0x01,           //     USAGE_MINIMUM (Button 1)
-	0x29, 0x08,           //     USAGE_MAXIMUM (Button 8)
-	0x15, 0x00,           //     LOGICAL_MINIMUM (0)
-	0x25, 0x01,           //     LOGICAL_MAXIMUM (1)
-	0x75, 0x01,           //     REPORT_SIZE (1)
-	0x95, 0x08,           //     REPORT_COUNT (8)
-	0x81, 0x02,           //     INPUT (Data,Var,Abs)
+  0x05, 0x09,           //     USAGE_PAGE (Button)
+  0x19, 0x01,           //     USAGE_MINIMUM (Button 1)
+  0x29, 0x10,           //     USAGE_MAXIMUM (Button 16)
+  0x15, 0x00,           //     LOGICAL_MINIMUM (0)
+  0x25, 0x01,           //     LOGICAL_MAXIMUM (1)
+  0x75, 0x01,           //     REPORT_SIZE (1)
+  0x95, 0x10,           //     REPORT_COUNT (16)
+  0x81, 0x02,           //     INPUT (Data,Var,Abs)
   0x05, 0x01,           //     USAGE_PAGE (Generic Desktop)
-	0x09, 0x30,           //     USAGE (X)
-	0x09, 0x31,           //     USAGE (Y)
+  0x09, 0x39,           //     USAGE (Hat switch)
+  0x15, 0x00,           //     LOGICAL_MINIMUM (0)
+  0x25, 0x07,           //     LOGICAL_MAXIMUM (7)
+  0x35, 0x00,           //     PHYSICAL_MINIMUM (0)
+  0x46, 0x3b, 0x01,     //     PHYSICAL_MAXIMUM (315)
+  0x65, 0x14,           //     UNIT (Eng Rot: Degrees)
+  0x75, 0x04,           //     REPORT_SIZE (4)
+  0x95, 0x01,           //     REPORT_COUNT (1)
+  0x81, 0x42,           //     INPUT (Data,Var,Abs,Null)
+  0x45, 0x00,           //     PHYSICAL_MAXIMUM (0)
+  0x65, 0x00,           //     UNIT (None)
+  0x81, 0x03,           //     INPUT (Cnst,Var,Abs)
+  0x09, 0x30,           //     USAGE (X)
+  0x09, 0x31,           //     USAGE (Y)
   0x15, 0x81,           //     LOGICAL_MINIMUM (-127)
   0x25, 0x7f,           //     LOGICAL_MAXIMUM (127)
-	0x75, 0x08,           //     REPORT_SIZE (8)
-	0x95, 0x02,           //     REPORT_COUNT (2)
-	0x81, 0x02,           //     INPUT (Data,Var,Abs)
-	0xc0,                 //   END_COLLECTION
-	0xc0                  // END_COLLECTION
+  0x75, 0x08,           //     REPORT_SIZE (8)
+  0x95, 0x02,           //     REPORT_COUNT (2)
+  0x81, 0x02,           //     INPUT (Data,Var,Abs)
+  0x09, 0x37,           //     USAGE (Dial)
+  0x09, 0x36,           //     USAGE (Slider)
+  0x15, 0x00,           //     LOGICAL_MINIMUM (0)
+  0x26, 0xff, 0x00,     //     LOGICAL_MAXIMUM (255)
+  0x75, 0x08,           //     REPORT_SIZE (8)
+  0x95, 0x02,           //     REPORT_COUNT (2)
+  0x81, 0x02,           //     INPUT (Data,Var,Abs)
+  0xc0,                 //   END_COLLECTION
+  0xc0,                 // END_COLLECTION
+
+  // Radial controller (Surface Dial) with button and dial in 0.1 degree units
+  0x05, 0x01,           // USAGE_PAGE (Generic Desktop)
+  0x09, 0x0e,           // USAGE (System Multi-Axis Controller)
+  0xa1, 0x01,           // COLLECTION (Application)
+  0x85, 0x05,           //   REPORT_ID (5)
+  0x05, 0x0d,           //   USAGE_PAGE (Digitizers)
+  0x09, 0x21,           //   USAGE (Puck)
+  0xa1, 0x00,           //   COLLECTION (Physical)
+  0x05, 0x09,           //     USAGE_PAGE (Button)
+  0x09, 0x01,           //     USAGE (Button 1)
+  0x15, 0x00,           //     LOGICAL_MINIMUM (0)
+  0x25, 0x01,           //     LOGICAL_MAXIMUM (1)
+  0x75, 0x01,           //     REPORT_SIZE (1)
+  0x95, 0x01,           //     REPORT_COUNT (1)
+  0x81, 0x02,           //     INPUT (Data,Var,Abs)
+  0x05, 0x01,           //     USAGE_PAGE (Generic Desktop)
+  0x09, 0x37,           //     USAGE (Dial)
+  0x55, 0x0f,           //     UNIT_EXPONENT (-1)
+  0x65, 0x14,           //     UNIT (Eng Rot: Degrees)
+  0x36, 0xf0, 0xf1,     //     PHYSICAL_MINIMUM (-3600)
+  0x46, 0x10, 0x0e,     //     PHYSICAL_MAXIMUM (3600)
+  0x16, 0xf0, 0xf1,     //     LOGICAL_MINIMUM (-3600)
+  0x26, 0x10, 0x0e,     //     LOGICAL_MAXIMUM (3600)
+  0x75, 0x0f,           //     REPORT_SIZE (15)
+  0x95, 0x01,           //     REPORT_COUNT (1)
+  0x81, 0x06,           //     INPUT (Data,Var,Rel)
+  0xc0,                 //   END_COLLECTION
+  0xc0                  // END_COLLECTION
 };
 
-__code uint8_t ReportDescrLen = sizeof(ReportDescr);
+// ===================================================================================
+// Raw HID Report Descriptor (Interface 1)
+// ===================================================================================
+__code uint8_t RawReportDescr[] ={
+  0x06, 0x00, 0xff,     // USAGE_PAGE (Vendor Defined Page 1)
+  0x09, 0x01,           // USAGE (Vendor Usage 1)
+  0xa1, 0x01,           // COLLECTION (Application)
+  0x15, 0x00,           //   LOGICAL_MINIMUM (0)
+  0x26, 0xff, 0x00,     //   LOGICAL_MAXIMUM (255)
+  0x75, 0x08,           //   REPORT_SIZE (8)
+  0x95, EP3_SIZE,       //   REPORT_COUNT (64)
+  0x09, 0x02,           //   USAGE (Vendor Usage 2)
+  0x81, 0x02,           //   INPUT (Data,Var,Abs)
+  0x95, EP3_SIZE,       //   REPORT_COUNT (64)
+  0x09, 0x03,           //   USAGE (Vendor Usage 3)
+  0x91, 0x02,           //   OUTPUT (Data,Var,Abs)
+  0xc0                  // END_COLLECTION
+};
+
+// ===================================================================================
+// BOS, WebUSB and MS OS 2.0 Descriptors
+// ===================================================================================
+#if USB_WEBUSB
+
+// BOS Descriptor (Type USB_DESCR_TYP_BOS, Index 0)
+__code USB_BOS_DESCR_FULL BOSDescr = {
+
+  // BOS Header
+  .bos = {
+    .bLength            = sizeof(USB_BOS_DESCR),  // size of the descriptor in bytes: 5
+    .bDescriptorType    = USB_DESCR_TYP_BOS,      // BOS descriptor: 0x0F
+    .wTotalLength       = sizeof(BOSDescr),       // total length in bytes
+    .bNumDeviceCaps     = 2                       // number of capabilities: 2
+  },
+
+  // Platform Capability: WebUSB {3408b638-09a9-47a0-8bfd-a0768815b665}
+  .webusb = {
+    .bLength            = sizeof(USB_WEBUSB_CAP_DESCR), // size in bytes: 24
+    .bDescriptorType    = USB_DESCR_TYP_DEVCAP,   // device capability: 0x10
+    .bDevCapabilityType = USB_DEVCAP_PLATFORM,    // platform capability: 0x05
+    .bReserved          = 0,
+    .PlatformCapabilityUUID = { 0x38, 0xB6, 0x08, 0x34, 0xA9, 0x09, 0xA0, 0x47,
+                                0x8B, 0xFD, 0xA0, 0x76, 0x88, 0x15, 0xB6, 0x65 },
+    .bcdVersion         = 0x0100,                 // WebUSB version 1.0
+    .bVendorCode        = USB_VENDOR_CODE,        // bRequest of GET_URL
+    .iLandingPage       = 1                       // landing page URL index
+  },
+
+  // Platform Capability: MS OS 2.0 {d8dd60df-4589-4cc7-9cd2-659d9e648a9f}
+  .msos20 = {
+    .bLength            = sizeof(USB_MSOS20_CAP_DESCR), // size in bytes: 28
+    .bDescriptorType    = USB_DESCR_TYP_DEVCAP,   // device capability: 0x10
+    .bDevCapabilityType = USB_DEVCAP_PLATFORM,    // platform capability: 0x05
+    .bReserved          = 0,
+    .PlatformCapabilityUUID = { 0xDF, 0x60, 0xDD, 0xD8, 0x89, 0x45, 0xC7, 0x4C,
+                                0x9C, 0xD2, 0x65, 0x9D, 0x9E, 0x64, 0x8A, 0x9F },
+    .dwWindowsVersion   = MS_OS_20_WINDOWS_8_1,   // minimum Windows version
+    .wMSOSDescriptorSetTotalLength = sizeof(MS_OS_20_DESCR_SET),
+    .bMS_VendorCode     = USB_VENDOR_CODE,        // bRequest of descriptor set request
+    .bAltEnumCode       = 0                       // no alternate enumeration
+  }
+};
+
+// MS OS 2.0 Descriptor Set: MS_OS_20_DESCRIPTOR_INDEX (Type USB_DESCR_TYP_VENDOR, Index 7)
+__code MS_OS_20_DESCR_SET MSOS20Descr = {
+
+  // Descriptor Set Header
+  .header = {
+    .wLength            = sizeof(MS_OS_20_SET_HEADER_DESCR),  // 10
+    .wDescriptorType    = MS_OS_20_SET_HEADER,
+    .dwWindowsVersion   = MS_OS_20_WINDOWS_8_1,
+    .wTotalLength       = sizeof(MS_OS_20_DESCR_SET)
+  },
+
+  // Configuration Subset Header
+  .config = {
+    .wLength            = sizeof(MS_OS_20_CONFIG_SUBSET_DESCR), // 8
+    .wDescriptorType    = MS_OS_20_SUBSET_CONFIGURATION,
+    .bConfigurationValue= 0,                      // configuration index
+    .bReserved          = 0,
+    .wTotalLength       = sizeof(MS_OS_20_DESCR_SET) - sizeof(MS_OS_20_SET_HEADER_DESCR)
+  },
+
+  // Function Subset Header: vendor interface
+  .function = {
+    .wLength            = sizeof(MS_OS_20_FUNCTION_SUBSET_DESCR), // 8
+    .wDescriptorType    = MS_OS_20_SUBSET_FUNCTION,
+    .bFirstInterface    = USB_VENDOR_INTERFACE,
+    .bReserved          = 0,
+    .wSubsetLength      = sizeof(MS_OS_20_FUNCTION_SUBSET_DESCR)
+                        + sizeof(MS_OS_20_COMPATIBLE_ID_DESCR)
+                        + sizeof(MS_OS_20_GUIDS_PROPERTY_DESCR)
+  },
+
+  // Compatible ID: WinUSB driver
+  .compatibleID = {
+    .wLength            = sizeof(MS_OS_20_COMPATIBLE_ID_DESCR), // 20
+    .wDescriptorType    = MS_OS_20_FEATURE_COMPATIBLE_ID,
+    .CompatibleID       = { 'W','I','N','U','S','B',0,0 },
+    .SubCompatibleID    = { 0,0,0,0,0,0,0,0 }
+  },
+
+  // Registry Property: device interface GUID to find the vendor interface
+  .guids = {
+    .wLength            = sizeof(MS_OS_20_GUIDS_PROPERTY_DESCR), // 132
+    .wDescriptorType    = MS_OS_20_FEATURE_REG_PROPERTY,
+    .wPropertyDataType  = MS_OS_20_REG_MULTI_SZ,
+    .wPropertyNameLength= sizeof(MSOS20Descr.guids.PropertyName),
+    .PropertyName       = { 'D','e','v','i','c','e','I','n','t','e','r','f','a','c','e',
+                            'G','U','I','D','s',0 },
+    .wPropertyDataLength= sizeof(MSOS20Descr.guids.PropertyData),
+    .PropertyData       = { '{','5','0','4','2','6','e','f','e','-','2','3','5','8','-',
+                            '4','0','0','6','-','a','2','8','0','-','a','c','3','8','2',
+                            'd','4','7','f','d','d','e','}',0,0 }
+  }
+};
+
+// WebUSB URL Descriptor: WEBUSB_REQUEST_GET_URL (Type USB_DESCR_TYP_VENDOR, Index 2)
+__code WEBUSB_URL_DESCR URLDescr = {
+  .bLength            = sizeof(WEBUSB_URL_DESCR), // size of the descriptor in bytes
+  .bDescriptorType    = WEBUSB_DESCR_TYP_URL,     // URL descriptor: 0x03
+  .bScheme            = WEBUSB_URL_SCHEME_HTTPS,  // https://
+  .URL                = WEBUSB_URL
+};
+
+#endif
 
 // ===================================================================================
 // String Descriptors
@@ -221,3 +788,26 @@ __code uint16_t SerDescr[] = {
 // Interface String Descriptor (Index 4)
 __code uint16_t InterfDescr[] = {
   ((uint16_t)USB_DESCR_TYP_STRING << 8) | sizeof(InterfDescr), INTERFACE_STR };
+
+// ===================================================================================
+// Descriptor Directory (generated by tools/usbdescr.py, do not edit)
+// ===================================================================================
+__code USB_DESCR_DIR DescrDir[] = {
+  { USB_DESCR_TYP_DEVICE,  0,     (__code uint8_t*)&DevDescr,      sizeof(DevDescr) },
+  { USB_DESCR_TYP_CONFIG,  0,     (__code uint8_t*)&CfgDescr,      sizeof(CfgDescr) },
+  { USB_DESCR_TYP_REPORT,  0,     (__code uint8_t*)ReportDescr,    sizeof(ReportDescr) },
+  { USB_DESCR_TYP_REPORT,  1,     (__code uint8_t*)RawReportDescr, sizeof(RawReportDescr) },
+  #if USB_WEBUSB
+  { USB_DESCR_TYP_BOS,     0,     (__code uint8_t*)&BOSDescr,      sizeof(BOSDescr) },
+  { USB_DESCR_TYP_VENDOR,  7,     (__code uint8_t*)&MSOS20Descr,   sizeof(MSOS20Descr) },
+  { USB_DESCR_TYP_VENDOR,  2,     (__code uint8_t*)&URLDescr,      sizeof(URLDescr) },
+  #endif
+  { USB_DESCR_TYP_STRING,  0,     (__code uint8_t*)LangDescr,      sizeof(LangDescr) },
+  { USB_DESCR_TYP_STRING,  1,     (__code uint8_t*)ManufDescr,     sizeof(ManufDescr) },
+  { USB_DESCR_TYP_STRING,  2,     (__code uint8_t*)ProdDescr,      sizeof(ProdDescr) },
+  { USB_DESCR_TYP_STRING,  3,     (__code uint8_t*)SerDescr,       sizeof(SerDescr) },
+  { USB_DESCR_TYP_STRING,  4,     (__code uint8_t*)InterfDescr,    sizeof(InterfDescr) },
+};
+
+__code uint8_t DescrDirCount = sizeof(DescrDir) / sizeof(USB_DESCR_DIR);
+// End of Descriptor Directory
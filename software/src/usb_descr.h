@@ -9,6 +9,11 @@
 // USB_PRODUCT_ID           - Product ID (16-bit word)
 // USB_DEVICE_VERSION       - Device version (16-bit BCD)
 // USB_MAX_POWER_mA         - Device max power in mA
+// USB_MIDI                 - USB MIDI interface on EP4 (0: off, 1: on)
+// USB_CDC                  - CDC-ACM console on EP4 and EP2 IN (0: off, 1: on)
+// USB_WEBUSB               - BOS with WebUSB and MS OS 2.0 descriptors and vendor
+//                            interface for driverless access (0: off, 1: on)
+// WEBUSB_URL               - WebUSB landing page (string without "https://")
 // All string descriptors.
 
 #pragma once
@@ -19,19 +24,65 @@
 // ===================================================================================
 // USB Endpoint Addresses and Sizes
 // ===================================================================================
-#define EP0_SIZE        8
-#define EP1_SIZE        8
+#define EP0_SIZE        64
+#define EP1_SIZE        16
 #define EP2_SIZE        8
+#define EP3_SIZE        64
+#define EP4_SIZE        64
 
 #define EP0_ADDR        0
-#define EP1_ADDR        (EP0_ADDR + EP0_BUF_SIZE)
+#if USB_MIDI || USB_CDC
+  #define EP4_ADDR      (EP0_ADDR + 64)             // fixed by hardware: after EP0
+  #define EP4_BUF_SIZE  (2 * EP4_SIZE)              // OUT buffer followed by IN buffer
+  #define EP1_ADDR      (EP4_ADDR + EP4_BUF_SIZE)
+#else
+  #define EP1_ADDR      (EP0_ADDR + EP0_BUF_SIZE)
+#endif
 #define EP2_ADDR        (EP1_ADDR + EP1_BUF_SIZE)
+#define EP3_ADDR        (EP2_ADDR + EP2_BUF_SIZE)
 
 #define EP0_BUF_SIZE    EP_BUF_SIZE(EP0_SIZE)
 #define EP1_BUF_SIZE    EP_BUF_SIZE(EP1_SIZE)
-#define EP2_BUF_SIZE    EP_BUF_SIZE(EP2_SIZE)
+#if USB_CDC                                         // OUT buffer, CDC notification
+  #define EP2_BUF_SIZE  (64 + EP_BUF_SIZE(EP2_SIZE))  // IN buffer follows at +64
+#else
+  #define EP2_BUF_SIZE  EP_BUF_SIZE(EP2_SIZE)
+#endif
+#define EP3_BUF_SIZE    (2 * EP_BUF_SIZE(EP3_SIZE))   // OUT buffer followed by IN buffer
 
 #define EP_BUF_SIZE(x)  (x+2<64 ? x+2 : 64)
+#define EP_BUF_END      (EP3_ADDR + EP3_BUF_SIZE)   // end of last endpoint buffer
+
+// The endpoint buffers are placed one after the other at the start of XRAM, which
+// is reserved for them by XRAM_LOC (set as USB_RAM_SIZE by the makefile, ch55xduino
+// passes it as USER_USB_RAM).
+#ifndef USB_RAM_SIZE
+  #ifdef USER_USB_RAM
+    #define USB_RAM_SIZE  USER_USB_RAM
+  #else
+    #define USB_RAM_SIZE  256
+  #endif
+#endif
+
+#if USB_MIDI && USB_CDC
+  #error USB_MIDI and USB_CDC both need EP4, enable only one of them!
+#endif
+#if (USB_MIDI || USB_CDC) && EP0_BUF_SIZE != 64
+  #error EP4 buffers are fixed at EP0 + 64, EP0 buffer must be 64 bytes!
+#endif
+#if EP_BUF_END > USB_RAM_SIZE
+  #error Endpoint buffers do not fit into USB RAM, increase XRAM_LOC!
+#endif
+#if (EP1_ADDR | EP2_ADDR | EP3_ADDR) & 1
+  #error Endpoint buffer addresses must be even!
+#endif
+
+// ===================================================================================
+// Interfaces
+// ===================================================================================
+// 0: HID composite, 1: Raw HID, 2+3: MIDI or CDC (optional), then vendor (optional)
+#define USB_VENDOR_INTERFACE  (USB_MIDI || USB_CDC ? 4 : 2)
+#define USB_INTERFACES        (USB_VENDOR_INTERFACE + (USB_WEBUSB ? 1 : 0))
 
 // ===================================================================================
 // Device and Configuration Descriptors
@@ -42,20 +93,85 @@ typedef struct _USB_CFG_DESCR_HID {
   USB_HID_DESCR hid0;
   USB_ENDP_DESCR ep1IN;
   USB_ENDP_DESCR ep2OUT;
+  USB_ITF_DESCR interface1;
+  USB_HID_DESCR hid1;
+  USB_ENDP_DESCR ep3IN;
+  USB_ENDP_DESCR ep3OUT;
+  #if USB_MIDI
+  USB_ITF_DESCR interface2;
+  USB_AC_HEADER_DESCR acHeader;
+  USB_ITF_DESCR interface3;
+  USB_MS_HEADER_DESCR msHeader;
+  USB_MIDI_IN_JACK_DESCR jackInEmb;
+  USB_MIDI_IN_JACK_DESCR jackInExt;
+  USB_MIDI_OUT_JACK_DESCR jackOutEmb;
+  USB_MIDI_OUT_JACK_DESCR jackOutExt;
+  USB_AUDIO_ENDP_DESCR ep4OUT;
+  USB_MS_ENDP_DESCR ms4OUT;
+  USB_AUDIO_ENDP_DESCR ep4IN;
+  USB_MS_ENDP_DESCR ms4IN;
+  #endif
+  #if USB_CDC
+  USB_IAD_DESCR association2;
+  USB_ITF_DESCR interface2;
+  USB_CDC_HEADER_DESCR cdcHeader;
+  USB_CDC_CALL_MGMT_DESCR cdcCallMgmt;
+  USB_CDC_ACM_DESCR cdcAcm;
+  USB_CDC_UNION_DESCR cdcUnion;
+  USB_ENDP_DESCR ep2IN;
+  USB_ITF_DESCR interface3;
+  USB_ENDP_DESCR ep4OUT;
+  USB_ENDP_DESCR ep4IN;
+  #endif
+  #if USB_WEBUSB
+  USB_ITF_DESCR interfaceVendor;
+  #endif
 } USB_CFG_DESCR_HID, *PUSB_CFG_DESCR_HID;
 typedef USB_CFG_DESCR_HID __xdata *PXUSB_CFG_DESCR_HID;
 
 extern __code USB_DEV_DESCR DevDescr;
 extern __code USB_CFG_DESCR_HID CfgDescr;
 
+// ===================================================================================
+// BOS, WebUSB and MS OS 2.0 Descriptors
+// ===================================================================================
+#if USB_WEBUSB
+#define USB_VENDOR_CODE       0x01      // bRequest of WebUSB and MS OS 2.0 requests
+
+typedef struct _USB_BOS_DESCR_FULL {
+  USB_BOS_DESCR bos;
+  USB_WEBUSB_CAP_DESCR webusb;
+  USB_MSOS20_CAP_DESCR msos20;
+} USB_BOS_DESCR_FULL;
+
+typedef struct _MS_OS_20_DESCR_SET {
+  MS_OS_20_SET_HEADER_DESCR header;
+  MS_OS_20_CONFIG_SUBSET_DESCR config;
+  MS_OS_20_FUNCTION_SUBSET_DESCR function;
+  MS_OS_20_COMPATIBLE_ID_DESCR compatibleID;
+  MS_OS_20_GUIDS_PROPERTY_DESCR guids;
+} MS_OS_20_DESCR_SET;
+
+typedef struct _WEBUSB_URL_DESCR {
+  uint8_t bLength;
+  uint8_t bDescriptorType;
+  uint8_t bScheme;
+  char    URL[sizeof(WEBUSB_URL) - 1];          // without terminating zero
+} WEBUSB_URL_DESCR;
+
+extern __code USB_BOS_DESCR_FULL BOSDescr;
+extern __code MS_OS_20_DESCR_SET MSOS20Descr;
+extern __code WEBUSB_URL_DESCR URLDescr;
+#endif
+
 // ===================================================================================
 // HID Report Descriptors
 // ===================================================================================
 extern __code uint8_t ReportDescr[];
-extern __code uint8_t ReportDescrLen;
+extern __code uint8_t RawReportDescr[];
 
-#define USB_REPORT_DESCR      ReportDescr
-#define USB_REPORT_DESCR_LEN  ReportDescrLen
+// Wheel/pan resolution multiplier (high-resolution scroll units per notch)
+#define MOUSE_WHEEL_RES       8
 
 // ===================================================================================
 // String Descriptors
@@ -66,9 +182,20 @@ extern __code uint16_t ProdDescr[];
 extern __code uint16_t SerDescr[];
 extern __code uint16_t InterfDescr[];
 
-#define USB_STR_DESCR_i0    (uint8_t*)LangDescr
-#define USB_STR_DESCR_i1    (uint8_t*)ManufDescr
-#define USB_STR_DESCR_i2    (uint8_t*)ProdDescr
-#define USB_STR_DESCR_i3    (uint8_t*)SerDescr
-#define USB_STR_DESCR_i4    (uint8_t*)InterfDescr
-#define USB_STR_DESCR_ix    (uint8_t*)SerDescr
+// ===================================================================================
+// Descriptor Directory
+// ===================================================================================
+// Generated at the end of usb_descr.c by tools/usbdescr.py ("make descr").
+// For report descriptors the index is the interface number (wIndex of the request),
+// for all other descriptors the descriptor index (low byte of wValue).
+#define USB_DESCR_TYP_VENDOR  0xFF      // vendor request descriptors, index is wIndex
+
+typedef struct _USB_DESCR_DIR {
+  uint8_t  bDescriptorType;                 // descriptor type
+  uint8_t  bIndex;                          // descriptor index or interface number
+  __code uint8_t *pDescr;                   // pointer to descriptor
+  uint16_t wLength;                         // length of descriptor in bytes
+} USB_DESCR_DIR;
+
+extern __code USB_DESCR_DIR DescrDir[];
+extern __code uint8_t DescrDirCount;
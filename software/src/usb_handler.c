@@ -4,16 +4,20 @@
 
 #include "ch554.h"
 #include "usb_handler.h"
+#include "delay.h"
 
 uint16_t SetupLen;
-uint8_t  SetupReq, UsbConfig;
+uint8_t  SetupReq;
+volatile uint8_t UsbConfig = 0;                     // configuration set by host
 __code uint8_t *pDescr;
+__bit    USB_wakeupEnabled = 0;                     // remote wakeup allowed by host
+volatile __bit USB_suspended = 0;                   // bus is suspended by host
 
 // ===================================================================================
 // Fast Copy Function
 // ===================================================================================
 // Copy descriptor *pDescr to Ep0 using double pointer
-// (Thanks to Ralph Doncaster)
+// (Thanks to Ralph Doncaster). Copies up to a full EP0 packet, len must not be 0.
 #pragma callee_saves USB_EP0_copyDescr
 void USB_EP0_copyDescr(uint8_t len) {
   len;                          // stop unreferenced argument warning
@@ -35,18 +39,53 @@ void USB_EP0_copyDescr(uint8_t len) {
   __endasm;
 }
 
+// ===================================================================================
+// Descriptor Lookup
+// ===================================================================================
+// Search descriptor in directory, limit SetupLen to its length and copy the first
+// packet to EP0. Following packets are sent by USB_EP0_IN(). Returns the length of
+// the first packet or 0xFF if the descriptor is not found.
+uint8_t USB_EP0_getDescr(uint8_t typ, uint8_t idx) {
+  uint8_t i, len;
+  __code USB_DESCR_DIR *dir;
+  for(dir = DescrDir, i = DescrDirCount; i; dir++, i--) {
+    if(dir->bDescriptorType == typ && dir->bIndex == idx) {
+      pDescr = dir->pDescr;                       // put descriptor into out buffer
+      if(SetupLen > dir->wLength) SetupLen = dir->wLength;  // limit length
+      len = SetupLen >= EP0_SIZE ? EP0_SIZE : SetupLen;
+      if(len) USB_EP0_copyDescr(len);             // copy descriptor to Ep0
+      SetupLen -= len;
+      pDescr += len;
+      return len;
+    }
+  }
+  return 0xFF;                                    // unsupported descriptor
+}
+
 // ===================================================================================
 // Endpoint Handler
 // ===================================================================================
 
 void USB_EP0_SETUP(void) {
   uint8_t len = USB_RX_LEN;
+  uint8_t typ, idx;
+  #ifdef USB_CTRL_SETUP_handler
+  USB_CTRL_SETUP_handler();                       // previous transfer is aborted
+  #endif
   if(len == (sizeof(USB_SETUP_REQ))) {
     SetupLen = ((uint16_t)USB_setupBuf->wLengthH<<8) | (USB_setupBuf->wLengthL);
     len = 0;                                      // default is success and upload 0 length
     SetupReq = USB_setupBuf->bRequest;
 
     if( (USB_setupBuf->bRequestType & USB_REQ_TYP_MASK) != USB_REQ_TYP_STANDARD ) {
+      #ifdef USB_VENDOR_CODE
+      if( USB_setupBuf->bRequestType == (USB_REQ_TYP_IN | USB_REQ_TYP_VENDOR | USB_REQ_RECIP_DEVICE)
+        && SetupReq == USB_VENDOR_CODE ) {        // MS OS 2.0 descriptor set, WebUSB URL
+        SetupReq = USB_GET_DESCRIPTOR;            // further packets by descriptor path
+        len = USB_EP0_getDescr(USB_DESCR_TYP_VENDOR, USB_setupBuf->wIndexL);
+      }
+      else
+      #endif
       #ifdef USB_CTRL_NS_handler
       len = USB_CTRL_NS_handler();                // non-standard request
       #else
@@ -57,72 +96,11 @@ void USB_EP0_SETUP(void) {
     else {                                        // standard request
       switch(SetupReq) {                          // request ccfType
         case USB_GET_DESCRIPTOR:
-          switch(USB_setupBuf->wValueH) {
-
-            case USB_DESCR_TYP_DEVICE:            // Device Descriptor
-              pDescr = (uint8_t*)&DevDescr;       // put descriptor into out buffer
-              len = sizeof(DevDescr);             // descriptor length
-              break;
-
-            case USB_DESCR_TYP_CONFIG:            // Configuration Descriptor
-              pDescr = (uint8_t*)&CfgDescr;       // put descriptor into out buffer
-              len = sizeof(CfgDescr);             // descriptor length
-              break;
-
-            case USB_DESCR_TYP_STRING:
-              switch(USB_setupBuf->wValueL) {      // String Descriptor Index
-                case 0:   pDescr = USB_STR_DESCR_i0; break;
-                case 1:   pDescr = USB_STR_DESCR_i1; break;
-                case 2:   pDescr = USB_STR_DESCR_i2; break;
-                case 3:   pDescr = USB_STR_DESCR_i3; break;
-                #ifdef USB_STR_DESCR_i4
-                case 4:   pDescr = USB_STR_DESCR_i4; break;
-                #endif
-                #ifdef USB_STR_DESCR_i5
-                case 5:   pDescr = USB_STR_DESCR_i5; break;
-                #endif
-                #ifdef USB_STR_DESCR_i6
-                case 6:   pDescr = USB_STR_DESCR_i6; break;
-                #endif
-                #ifdef USB_STR_DESCR_i7
-                case 7:   pDescr = USB_STR_DESCR_i7; break;
-                #endif
-                #ifdef USB_STR_DESCR_i8
-                case 8:   pDescr = USB_STR_DESCR_i8; break;
-                #endif
-                #ifdef USB_STR_DESCR_i9
-                case 9:   pDescr = USB_STR_DESCR_i9; break;
-                #endif
-                #ifdef USB_STR_DESCR_ixee
-                case 0xee: pDescr = USB_STR_DESCR_ixee; break;
-                #endif
-                default:  pDescr = USB_STR_DESCR_ix; break;
-              }
-              len = pDescr[0];                    // descriptor length
-              break;
-
-            #ifdef USB_REPORT_DESCR
-            case USB_DESCR_TYP_REPORT:
-              if(USB_setupBuf->wValueL == 0) {
-                pDescr = USB_REPORT_DESCR;
-                len = USB_REPORT_DESCR_LEN;
-              }
-              else len = 0xff;
-              break;
-            #endif
-
-            default:
-              len = 0xff;                         // unsupported descriptors or error
-              break;
-          }
-
-          if(len != 0xff) {
-            if(SetupLen > len) SetupLen = len;    // limit length
-            len = SetupLen >= EP0_SIZE ? EP0_SIZE : SetupLen;
-            USB_EP0_copyDescr(len);               // copy descriptor to Ep0
-            SetupLen -= len;
-            pDescr += len;
-          }
+          typ = USB_setupBuf->wValueH;            // descriptor type
+          idx = (typ == USB_DESCR_TYP_REPORT)     // report descriptor by interface,
+              ? USB_setupBuf->wIndexL             // others by descriptor index
+              : USB_setupBuf->wValueL;
+          len = USB_EP0_getDescr(typ, idx);
           break;
 
         case USB_SET_ADDRESS:
@@ -148,7 +126,7 @@ void USB_EP0_SETUP(void) {
           if( (USB_setupBuf->bRequestType & 0x1F) == USB_REQ_RECIP_DEVICE ) {
             if( ( ( (uint16_t)USB_setupBuf->wValueH << 8 ) | USB_setupBuf->wValueL ) == 0x01 ) {
               if( ((uint8_t*)&CfgDescr)[7] & 0x20) {
-                // wake up
+                USB_wakeupEnabled = 0;        // remote wakeup disabled by host
               }
               else len = 0xFF;               // failed
             }
@@ -207,7 +185,8 @@ void USB_EP0_SETUP(void) {
         case USB_SET_FEATURE:
           if( (USB_setupBuf->bRequestType & 0x1F) == USB_REQ_RECIP_DEVICE ) {
             if( ( ( (uint16_t)USB_setupBuf->wValueH << 8 ) | USB_setupBuf->wValueL ) == 0x01 ) {
-              if( !(((uint8_t*)&CfgDescr)[7] & 0x20) ) len = 0xFF;  // failed
+              if( ((uint8_t*)&CfgDescr)[7] & 0x20) USB_wakeupEnabled = 1;
+              else len = 0xFF;                                      // failed
             }
             else len = 0xFF;                                        // failed
           }
@@ -266,6 +245,8 @@ void USB_EP0_SETUP(void) {
 
         case USB_GET_STATUS:
           EP0_buffer[0] = 0x00;
+          if( (USB_setupBuf->bRequestType & USB_REQ_RECIP_MASK) == USB_REQ_RECIP_DEVICE
+            && USB_wakeupEnabled ) EP0_buffer[0] = 0x02;     // remote wakeup enabled
           EP0_buffer[1] = 0x00;
           if(SetupLen >= 2) len = 2;
           else len = SetupLen;
@@ -299,7 +280,7 @@ void USB_EP0_IN(void) {
 
     case USB_GET_DESCRIPTOR:
       len = SetupLen >= EP0_SIZE ? EP0_SIZE : SetupLen;
-      USB_EP0_copyDescr(len);                     // copy descriptor to Ep0                                
+      if(len) USB_EP0_copyDescr(len);             // copy descriptor to Ep0 (0: ZLP)
       SetupLen  -= len;
       pDescr    += len;
       UEP0_T_LEN = len;
@@ -319,8 +300,13 @@ void USB_EP0_IN(void) {
 }
 
 void USB_EP0_OUT(void) {
-  UEP0_T_LEN = 0;
-  UEP0_CTRL |= UEP_R_RES_ACK | UEP_T_RES_NAK;     // respond Nak
+  uint8_t res = USB_CTRL_OUT_NONE;
+  #ifdef USB_CTRL_OUT_handler
+  res = USB_CTRL_OUT_handler();                   // data of non-standard request?
+  #endif
+  UEP0_T_LEN = 0;                                 // 0-length status packet or Nak
+  UEP0_CTRL  = UEP0_CTRL & ~(MASK_UEP_R_RES | MASK_UEP_T_RES) | UEP_R_RES_ACK
+             | (res == USB_CTRL_OUT_DONE ? UEP_T_RES_ACK : UEP_T_RES_NAK);
 }
 
 // ===================================================================================
@@ -421,6 +407,9 @@ void USB_interrupt(void) {   // inline not really working in multiple files in S
     #endif
 
     USB_DEV_AD   = 0x00;
+    UsbConfig    = 0;                       // not configured anymore
+    USB_wakeupEnabled = 0;
+    USB_suspended = 0;
     UIF_SUSPEND  = 0;
     UIF_TRANSFER = 0;
     UIF_BUS_RST  = 0;                       // clear interrupt flag
@@ -429,11 +418,26 @@ void USB_interrupt(void) {   // inline not really working in multiple files in S
   // USB bus suspend / wake up
   if (UIF_SUSPEND) {
     UIF_SUSPEND = 0;
-    if ( !(USB_MIS_ST & bUMS_SUSPEND) ) USB_INT_FG = 0xFF;  // clear interrupt flag
+    USB_suspended = (USB_MIS_ST & bUMS_SUSPEND) ? 1 : 0;    // suspend or resume?
+    if ( !USB_suspended ) USB_INT_FG = 0xFF;                 // clear interrupt flag
   }
 }
 #pragma restore
 
+// ===================================================================================
+// USB Remote Wakeup
+// ===================================================================================
+
+// Wake up suspended host if it allowed remote wakeup, return 1 if bus is active
+__bit USB_wakeup(void) {
+  if(!(USB_MIS_ST & bUMS_SUSPEND)) return 1;      // bus is not suspended
+  if(!USB_wakeupEnabled) return 0;                // host does not allow remote wakeup
+  UDEV_CTRL ^= bUD_LOW_SPEED;                     // drive resume signal (K state)
+  DLY_ms(2);                                      // for 1..15ms
+  UDEV_CTRL ^= bUD_LOW_SPEED;
+  return 1;
+}
+
 // ===================================================================================
 // USB Init Function
 // ===================================================================================
@@ -12,9 +12,17 @@
 __xdata __at (EP0_ADDR) uint8_t EP0_buffer[EP0_BUF_SIZE];     
 __xdata __at (EP1_ADDR) uint8_t EP1_buffer[EP1_BUF_SIZE];
 __xdata __at (EP2_ADDR) uint8_t EP2_buffer[EP2_BUF_SIZE];
+__xdata __at (EP3_ADDR) uint8_t EP3_buffer[EP3_BUF_SIZE];
+#if USB_MIDI || USB_CDC
+__xdata __at (EP4_ADDR) uint8_t EP4_buffer[EP4_BUF_SIZE];
+#endif
 
 #define USB_setupBuf ((PUSB_SETUP_REQ)EP0_buffer)
 extern uint8_t SetupReq;
+extern uint16_t SetupLen;
+extern volatile uint8_t UsbConfig;
+extern __bit USB_wakeupEnabled;
+extern volatile __bit USB_suspended;
 
 // ===================================================================================
 // Custom External USB Handler Functions
@@ -23,6 +31,16 @@ void HID_setup(void);
 void HID_reset(void);
 void HID_EP1_IN(void);
 void HID_EP2_OUT(void);
+uint8_t HID_CTRL_request(void);
+uint8_t HID_CTRL_OUT(void);
+void HID_CTRL_cancel(void);
+void RAW_EP3_IN(void);
+void RAW_EP3_OUT(void);
+void MIDI_EP4_IN(void);
+void MIDI_EP4_OUT(void);
+void CDC_EP2_IN(void);
+void CDC_EP4_IN(void);
+void CDC_EP4_OUT(void);
 
 // ===================================================================================
 // USB Handler Defines
@@ -30,6 +48,14 @@ void HID_EP2_OUT(void);
 // Custom USB handler functions
 #define USB_INIT_handler    HID_setup         // init custom endpoints
 #define USB_RESET_handler   HID_reset         // custom USB reset handler
+#define USB_CTRL_NS_handler HID_CTRL_request  // HID class requests
+#define USB_CTRL_OUT_handler HID_CTRL_OUT     // HID class request data stage
+#define USB_CTRL_SETUP_handler HID_CTRL_cancel // drop pending data stages on SETUP
+
+// Return values of USB_CTRL_OUT_handler
+#define USB_CTRL_OUT_NONE   0                 // data stage not consumed
+#define USB_CTRL_OUT_DONE   1                 // consumed, send status packet
+#define USB_CTRL_OUT_HOLD   2                 // consumed, status NAKed until released
 
 // Endpoint callback functions
 #define EP0_SETUP_callback  USB_EP0_SETUP
@@ -37,9 +63,22 @@ void HID_EP2_OUT(void);
 #define EP0_OUT_callback    USB_EP0_OUT
 #define EP1_IN_callback     HID_EP1_IN
 #define EP2_OUT_callback    HID_EP2_OUT
+#define EP3_IN_callback     RAW_EP3_IN
+#define EP3_OUT_callback    RAW_EP3_OUT
+#if USB_MIDI
+#define EP4_IN_callback     MIDI_EP4_IN
+#define EP4_OUT_callback    MIDI_EP4_OUT
+#endif
+#if USB_CDC
+#define EP2_IN_callback     CDC_EP2_IN
+#define EP4_IN_callback     CDC_EP4_IN
+#define EP4_OUT_callback    CDC_EP4_OUT
+#endif
 
 // ===================================================================================
 // Functions
 // ===================================================================================
 void USB_interrupt(void);
 void USB_init(void);
+__bit USB_wakeup(void);   // wake up suspended host, return 0 if not allowed
+#define USB_configured()  (UsbConfig != 0)    // device configured by host?
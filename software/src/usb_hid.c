@@ -6,12 +6,30 @@
 #include "usb.h"
 #include "usb_hid.h"
 #include "usb_descr.h"
+#include "usb_rawhid.h"
+#include "usb_midi.h"
+#include "usb_cdc.h"
+#include "timer.h"
+#include "stats.h"
 
 // ===================================================================================
 // Variables and Defines
 // ===================================================================================
 
 volatile __bit HID_EP1_writeBusyFlag = 0;                   // upload pointer busy flag
+__bit    HID_protocol = 1;                                  // 0: boot, 1: report protocol
+uint8_t  HID_idleRate[HID_REPORT_IDS];                      // per report ID, 4ms units
+uint16_t HID_idleTime[HID_REPORT_IDS];                      // time of last state report
+__bit    HID_idleActive = 0;                                // any idle rate is not 0
+volatile __bit HID_resetFlag = 0;                           // bus reset occurred
+volatile uint8_t HID_ledState = 0;                          // keyboard LED state from host
+volatile __bit   HID_ledChanged = 0;                        // LED state changed flag
+
+// Reports sent before the host has configured the device are queued as
+// [length][report] records and flushed as soon as it is configured. The queue is
+// only used outside of interrupts and survives bus resets (re-enumeration).
+__xdata uint8_t HID_queue[HID_QUEUE_SIZE];                  // queued reports
+uint8_t  HID_queueLen = 0;                                  // bytes in queue
 
 // ===================================================================================
 // Front End Functions
@@ -21,18 +39,86 @@ volatile __bit HID_EP1_writeBusyFlag = 0;                   // upload pointer bu
 void HID_init(void) {
   USB_init();
   UEP1_T_LEN  = 0;
+  HID_queueLen = 0;
 }
 
-// Send HID report
-void HID_sendReport(__xdata uint8_t* buf, uint8_t len) {
+// Upload HID report via EP1
+void HID_writeReport(__xdata uint8_t* buf, uint8_t len) {
   uint8_t i;
+  if(len > EP1_SIZE) len = EP1_SIZE;                        // never overrun EP1 buffer
   while(HID_EP1_writeBusyFlag);                             // wait for ready to write
   for(i=0; i<len; i++) EP1_buffer[i] = buf[i];              // copy report to EP1 buffer
-  UEP1_T_LEN = len;                                         // set length to upload
+  if(!HID_protocol) while(i < 8) EP1_buffer[i++] = 0;       // boot report has 8 bytes
+  UEP1_T_LEN = i;                                           // set length to upload
   HID_EP1_writeBusyFlag = 1;                                // set busy flag
+  STAT_reports++;                                           // count reports
+  if(!STAT_firstReport) STAT_firstReport = TIM_millis();    // time to first report
   UEP1_CTRL = UEP1_CTRL & ~MASK_UEP_T_RES | UEP_T_RES_ACK;  // upload data and respond ACK
 }
 
+// Send HID report (queued while the device is not configured yet), return 1 if the
+// report was sent or queued, 0 if it was dropped (e.g. queue full, no host)
+__bit HID_sendReport(__xdata uint8_t* buf, uint8_t len) {
+  uint8_t i;
+  if(!HID_protocol) {                                       // boot protocol?
+    if(buf[0] != HID_BOOT_REPORT_ID) return 0;              // only keyboard is allowed
+    buf++; len--;                                           // strip report ID
+  }
+  if(!USB_wakeup()) return 0;                               // host asleep and unwakeable
+  if(!USB_configured()) {                                   // still enumerating?
+    if(HID_queueLen + len < HID_QUEUE_SIZE) {               // room for length + report?
+      HID_queue[HID_queueLen++] = len;
+      for(i=0; i<len; i++) HID_queue[HID_queueLen++] = buf[i];
+      return 1;
+    }
+    return 0;                                               // queue full: don't wait
+  }
+  HID_flush();                                              // keep order of reports
+  HID_writeReport(buf, len);
+  return 1;
+}
+
+// Send queued reports as soon as the device is configured
+void HID_flush(void) {
+  uint8_t i, len;
+  if(!USB_configured()) return;                             // not configured yet
+  if(!STAT_configTime) {                                    // first time configured?
+    STAT_configTime = TIM_millis();
+    CDC_log("configured");
+  }
+  for(i=0; i<HID_queueLen; i+=len) {
+    len = HID_queue[i++];
+    if(len > HID_queueLen - i) break;                       // incomplete record
+    HID_writeReport(HID_queue + i, len);
+  }
+  HID_queueLen = 0;
+}
+
+// Send HID state report only if it differs from the last one sent or if the idle
+// period of its report ID (set by the host via SET_IDLE) has elapsed since then
+void HID_sendState(__xdata uint8_t* buf, __xdata uint8_t* last, uint8_t len) {
+  uint8_t i, id = buf[0];
+  for(i=0; i<len; i++) if(buf[i] != last[i]) break;        // compare with last report
+  if(i == len) {                                            // duplicate?
+    if(!HID_idleRate[id]) return;                           // infinite idle: suppress
+    if((uint16_t)(TIM_millis() - HID_idleTime[id]) < ((uint16_t)HID_idleRate[id] << 2))
+      return;
+  }
+  if(!HID_sendReport(buf, len)) return;                     // dropped: not sent yet
+  for(i=0; i<len; i++) last[i] = buf[i];                    // remember report
+  HID_idleTime[id] = TIM_millis();
+}
+
+// Set idle rate of a report ID (0: all report IDs), called in USB interrupt
+void HID_setIdle(uint8_t id, uint8_t rate) {
+  uint8_t i;
+  HID_idleActive = 0;
+  for(i=0; i<HID_REPORT_IDS; i++) {
+    if(!id || i == id) HID_idleRate[i] = rate;
+    if(HID_idleRate[i]) HID_idleActive = 1;
+  }
+}
+
 // ===================================================================================
 // HID-Specific USB Handler Functions
 // ===================================================================================
@@ -41,19 +127,41 @@ void HID_sendReport(__xdata uint8_t* buf, uint8_t len) {
 void HID_setup(void) {
   UEP1_DMA    = EP1_ADDR;                   // EP1 data transfer address
   UEP2_DMA    = EP2_ADDR;                   // EP2 data transfer address
+  UEP3_DMA    = EP3_ADDR;                   // EP3 data transfer address
   UEP1_CTRL   = bUEP_AUTO_TOG               // EP1 Auto flip sync flag
               | UEP_T_RES_NAK;              // EP1 IN transaction returns NAK
   UEP2_CTRL   = bUEP_AUTO_TOG               // EP2 Auto flip sync flag
               | UEP_R_RES_ACK;              // EP2 OUT transaction returns ACK
+  UEP3_CTRL   = bUEP_AUTO_TOG               // EP3 Auto flip sync flag
+              | UEP_T_RES_NAK               // EP3 IN transaction returns NAK
+              | UEP_R_RES_ACK;              // EP3 OUT transaction returns ACK
   UEP4_1_MOD  = bUEP1_TX_EN;                // EP1 TX enable
-  UEP2_3_MOD  = bUEP2_RX_EN;                // EP2 RX enable
+  UEP2_3_MOD  = bUEP2_RX_EN                 // EP2 RX enable
+              | bUEP3_RX_EN | bUEP3_TX_EN;  // EP3 RX and TX enable (OUT, then IN buffer)
+  #if USB_MIDI
+  MIDI_setup();                             // EP4 MIDI streaming endpoints
+  #endif
+  #if USB_CDC
+  CDC_setup();                              // EP2 IN and EP4 console endpoints
+  #endif
 }
 
 // Reset HID parameters
 void HID_reset(void) {
   UEP1_CTRL = bUEP_AUTO_TOG | UEP_T_RES_NAK;
   UEP2_CTRL = bUEP_AUTO_TOG | UEP_R_RES_ACK;
+  UEP3_CTRL = bUEP_AUTO_TOG | UEP_T_RES_NAK | UEP_R_RES_ACK;
   HID_EP1_writeBusyFlag = 0;
+  RAW_reset();                                              // drop pending command
+  HID_protocol = 1;                                         // report protocol after reset
+  HID_setIdle(0, 0);                                        // idle rates default to 0
+  HID_resetFlag = 1;                                        // forget last state reports
+  #if USB_MIDI
+  MIDI_reset();
+  #endif
+  #if USB_CDC
+  CDC_reset();
+  #endif
 }
 
 // Endpoint 1 IN handler (HID report transfer to host)
@@ -65,4 +173,13 @@ void HID_EP1_IN(void) {
 
 // Endpoint 2 OUT handler (HID report transfer from host)
 void HID_EP2_OUT(void) {                                    // auto response
+  if(U_TOG_OK && USB_RX_LEN)                                // keyboard LEDs are the last
+    HID_setLedState(EP2_buffer[USB_RX_LEN - 1]);            // byte, with or without ID
+}
+
+// Latch keyboard LED state received from host (called in USB interrupt)
+void HID_setLedState(uint8_t state) {
+  if(state == HID_ledState) return;                         // no change
+  HID_ledState = state;
+  HID_ledChanged = 1;
 }
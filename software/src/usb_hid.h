@@ -7,4 +7,24 @@
 #include "usb_handler.h"
 
 void HID_init(void);                                      // setup USB-HID
-void HID_sendReport(__xdata uint8_t* buf, uint8_t len);   // send HID report
+__bit HID_sendReport(__xdata uint8_t* buf, uint8_t len);  // send HID report
+void HID_sendState(__xdata uint8_t* buf, __xdata uint8_t* last, uint8_t len);
+                                                          // send report if changed/idle
+void HID_flush(void);                                     // send reports queued before
+                                                          // the device was configured
+
+extern volatile __bit HID_EP1_writeBusyFlag;              // EP1 upload busy flag
+extern __bit   HID_protocol;                              // 0: boot, 1: report protocol
+#define HID_REPORT_IDS      8                             // report IDs 0..7
+extern uint8_t HID_idleRate[HID_REPORT_IDS];              // idle rates in 4ms units
+extern __bit   HID_idleActive;                            // any idle rate is not 0
+extern volatile __bit HID_resetFlag;                      // bus reset occurred
+void HID_setIdle(uint8_t id, uint8_t rate);               // set idle rate (USB ISR)
+extern volatile uint8_t HID_ledState;                     // keyboard LED state from host
+extern volatile __bit   HID_ledChanged;                   // LED state changed flag
+void HID_setLedState(uint8_t state);                      // latch LED state (USB ISR)
+
+#define HID_QUEUE_SIZE      64                            // report queue size in bytes
+extern uint8_t HID_queueLen;                              // bytes in report queue
+
+#define HID_BOOT_REPORT_ID  1                             // report ID of boot keyboard
@@ -0,0 +1,84 @@
+// ===================================================================================
+// USB MIDI Interface for CH551, CH552 and CH554
+// ===================================================================================
+
+#include "ch554.h"
+#include "usb.h"
+#include "usb_midi.h"
+#include "usb_handler.h"
+
+#if USB_MIDI
+
+#define MIDI_txBuffer  (EP4_buffer + EP4_SIZE)              // IN buffer follows OUT
+
+__xdata uint8_t MIDI_buffer[EP4_SIZE];                      // queued event packets
+uint8_t MIDI_len = 0;                                       // bytes in buffer
+volatile __bit MIDI_writeBusyFlag = 0;                      // upload busy flag
+
+// ===================================================================================
+// Front End Functions
+// ===================================================================================
+
+// Queue USB-MIDI event packet of a channel message (dropped if buffer is full)
+void MIDI_send(uint8_t status, uint8_t d1, uint8_t d2) {
+  if(!USB_configured()) return;                             // nobody listens
+  if(MIDI_len > EP4_SIZE - 4) {                             // buffer full?
+    MIDI_flush();
+    if(MIDI_len) return;                                    // EP4 still busy: drop
+  }
+  MIDI_buffer[MIDI_len++] = status >> 4;                    // cable 0, code index
+  MIDI_buffer[MIDI_len++] = status | (MIDI_CHANNEL - 1);
+  MIDI_buffer[MIDI_len++] = d1 & 0x7F;
+  MIDI_buffer[MIDI_len++] = d2 & 0x7F;
+}
+
+// Send relative control change, steps as 7-bit two's complement (1 = +1, 127 = -1)
+void MIDI_ccRel(uint8_t ctrl, int8_t steps) {
+  if(steps >  63) steps =  63;
+  if(steps < -64) steps = -64;
+  MIDI_cc(ctrl, (uint8_t)steps & 0x7F);
+}
+
+// Upload queued event packets as one bulk packet via EP4
+void MIDI_flush(void) {
+  uint8_t i;
+  if(!MIDI_len || MIDI_writeBusyFlag) return;               // nothing to do yet
+  for(i=0; i<MIDI_len; i++) MIDI_txBuffer[i] = MIDI_buffer[i];
+  UEP4_T_LEN = MIDI_len;                                    // set length to upload
+  MIDI_len = 0;
+  MIDI_writeBusyFlag = 1;                                   // set busy flag
+  UEP4_CTRL = UEP4_CTRL & ~MASK_UEP_T_RES | UEP_T_RES_ACK;  // upload data and respond ACK
+}
+
+// ===================================================================================
+// MIDI USB Handler Functions
+// ===================================================================================
+
+// Setup EP4 (OUT buffer at EP0 + 64, IN buffer at EP0 + 128, fixed by hardware)
+void MIDI_setup(void) {
+  MIDI_reset();
+  UEP4_1_MOD |= bUEP4_RX_EN | bUEP4_TX_EN;                  // EP4 RX and TX enable
+}
+
+// Reset MIDI parameters
+void MIDI_reset(void) {
+  UEP4_T_LEN = 0;
+  UEP4_CTRL  = UEP_T_RES_NAK | UEP_R_RES_ACK;               // EP4 has no auto toggle
+  MIDI_writeBusyFlag = 0;
+  MIDI_len = 0;                                             // drop queued events
+}
+
+// Endpoint 4 IN handler (event transfer to host)
+void MIDI_EP4_IN(void) {
+  UEP4_T_LEN = 0;                                           // no data to send anymore
+  UEP4_CTRL ^= bUEP_T_TOG;                                  // manual data toggle
+  UEP4_CTRL = UEP4_CTRL & ~MASK_UEP_T_RES | UEP_T_RES_NAK;  // default NAK
+  MIDI_writeBusyFlag = 0;                                   // clear busy flag
+}
+
+// Endpoint 4 OUT handler (events from host, ignored)
+void MIDI_EP4_OUT(void) {
+  if(U_TOG_OK) UEP4_CTRL ^= bUEP_R_TOG;                     // manual data toggle
+}
+
+#endif // USB_MIDI
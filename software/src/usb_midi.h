@@ -0,0 +1,30 @@
+// ===================================================================================
+// USB MIDI Interface for CH551, CH552 and CH554
+// ===================================================================================
+//
+// USB MIDI 1.0 streaming interface with bulk IN/OUT endpoints (EP4). Each MIDI
+// message is sent as a 4-byte USB-MIDI event packet [cable|CIN] [status] [d1] [d2].
+// Events are collected in a buffer and sent by MIDI_flush(), which must be called
+// from the main loop, so up to 16 events (e.g. several keys and encoder steps of one
+// scan) share a single 64-byte packet. Events are dropped while the device is not
+// configured or the buffer is full, the scan loop is never blocked. MIDI data
+// received from the host is accepted and ignored.
+//
+// The following must be defined in config.h:
+// USB_MIDI             - MIDI interface enabled (needs 192 bytes more USB RAM)
+// MIDI_CHANNEL         - MIDI channel of sent events (1..16)
+
+#pragma once
+#include <stdint.h>
+
+void MIDI_send(uint8_t status, uint8_t d1, uint8_t d2);   // queue channel message
+void MIDI_flush(void);                                    // send queued events (loop)
+void MIDI_ccRel(uint8_t ctrl, int8_t steps);              // relative CC (two's compl.)
+
+#define MIDI_noteOn(note, vel)  MIDI_send(0x90, note, vel)
+#define MIDI_noteOff(note)      MIDI_send(0x80, note, 0)
+#define MIDI_cc(ctrl, val)      MIDI_send(0xB0, ctrl, val)
+
+extern volatile __bit MIDI_writeBusyFlag;                 // EP4 upload busy flag
+void MIDI_setup(void);                                    // enable EP4 (USB init)
+void MIDI_reset(void);                                    // reset EP4 (USB bus reset)
@@ -0,0 +1,276 @@
+// ===================================================================================
+// USB Raw HID Configuration Interface for CH551, CH552 and CH554
+// ===================================================================================
+
+#include "ch554.h"
+#include "usb.h"
+#include "usb_rawhid.h"
+#include "usb_handler.h"
+#include "settings.h"
+#include "unicode.h"
+#include "stats.h"
+#include "timer.h"
+#include "ledstream.h"
+#include "keymap.h"
+#include "mousekeys.h"
+#include "usb_composite.h"
+
+#define RAW_rxBuffer  (EP3_buffer)                          // command packet
+#define RAW_txBuffer  (EP3_buffer + RAW_SIZE)               // response packet
+
+volatile __bit RAW_readyFlag = 0;                           // command received flag
+volatile __bit RAW_writeBusyFlag = 0;                       // upload busy flag
+
+#if USB_WEBUSB
+__xdata uint8_t RAW_ctrlTxBuffer[RAW_SIZE];                 // response via control transfer
+uint8_t RAW_ctrlLen;                                        // command length in EP0 buffer
+volatile uint8_t RAW_ctrlSeq;                               // counts SETUP packets
+volatile __bit RAW_ctrlOutFlag = 0;                         // command data stage pending
+volatile __bit RAW_ctrlReadyFlag = 0;                       // command received flag
+volatile __bit RAW_ctrlDoneFlag = 0;                        // response ready flag
+#endif
+
+// ===================================================================================
+// Command Processing
+// ===================================================================================
+
+// Check keymap entry (type code param) sent by the host, return 0 if invalid
+__bit RAW_checkEntry(__xdata uint8_t* entry) {
+  switch(entry[0]) {
+    case MAP_MOUSEKEY:
+      return !(entry[1] & ~(MK_UP | MK_DOWN | MK_LEFT | MK_RIGHT));
+    case MAP_JOYHAT:
+      return entry[1] <= JOY_HAT_CENTER;
+    #if !USB_MIDI
+    case MAP_MIDI_NOTE:
+    case MAP_MIDI_CC:
+    case MAP_MIDI_REL:
+      return 0;                                             // no MIDI interface
+    #endif
+    default:
+      return entry[0] <= MAP_MIDI_REL;
+  }
+}
+
+// Execute command packet rx and write response packet tx
+void RAW_execute(__xdata uint8_t* rx, __xdata uint8_t* tx) {
+  uint8_t i, ofs, len, status;
+  __xdata uint8_t* set = (__xdata uint8_t*)&SET_data;
+
+  for(i=0; i<RAW_SIZE; i++) tx[i] = 0;
+  tx[0] = rx[0];
+  status = RAW_OK;
+  ofs    = 0;
+  len    = 0;
+
+  switch(rx[0]) {
+    case RAW_CMD_INFO:
+      tx[2] = (uint8_t)USB_DEVICE_VERSION;
+      tx[3] = (uint8_t)(USB_DEVICE_VERSION >> 8);
+      tx[4] = MAP_SLOTS;
+      tx[5] = SET_KEYS;
+      tx[6] = sizeof(SET_DATA);
+      tx[7] = RAW_PROTOCOL;
+      break;
+
+    case RAW_CMD_GET_MAP:
+    case RAW_CMD_SET_MAP:
+      ofs = rx[1];
+      len = rx[2];
+      if(ofs >= MAP_SLOTS || len > MAP_SLOTS - ofs) {
+        status = RAW_ERR_ARG;
+        len    = 0;
+        break;
+      }
+      ofs *= sizeof(MAP_ENTRY);
+      len *= sizeof(MAP_ENTRY);
+      if(rx[0] == RAW_CMD_SET_MAP) {
+        for(i=0; i<len; i+=sizeof(MAP_ENTRY)) if(!RAW_checkEntry(rx + 3 + i)) break;
+        if(i < len) {
+          status = RAW_ERR_ARG;                             // keep and echo old entries
+          break;
+        }
+        for(i=0; i<len; i++) set[ofs + i] = rx[3 + i];
+        SET_modified();
+      }
+      break;
+
+    case RAW_CMD_GET_LED:
+    case RAW_CMD_SET_LED:
+      ofs = (uint8_t)((__xdata uint8_t*)SET_data.hue - set);
+      len = SET_KEYS + 2;
+      if(rx[0] == RAW_CMD_SET_LED) {
+        for(i=0; i<SET_KEYS; i++) if(rx[1 + i] >= SET_HUES) break;
+        if(i < SET_KEYS || rx[1 + SET_KEYS] > SET_BRIGHT_MAX
+                        || rx[2 + SET_KEYS] > SET_BRIGHT_MAX) {
+          status = RAW_ERR_ARG;                             // keep and echo old values
+          break;
+        }
+        for(i=0; i<len; i++) set[ofs + i] = rx[1 + i];
+        SET_modified();
+      }
+      break;
+
+    case RAW_CMD_GET_PAR:
+    case RAW_CMD_SET_PAR:
+      ofs = (uint8_t)(&SET_data.scanDelay - set);
+      len = 6;
+      if(rx[0] == RAW_CMD_SET_PAR) {
+        if(rx[1] < SCAN_DELAY_MIN_ms || rx[1] > SCAN_DELAY_MAX_ms
+          || rx[2] < ENC_DEBOUNCE_MIN_ms || rx[2] > ENC_DEBOUNCE_MAX_ms
+          || rx[3] < ENC_CLICK_GAP_MIN_ms / 10 || rx[3] > ENC_CLICK_GAP_MAX_ms / 10
+          || rx[4] < ENC_LONG_PRESS_MIN_ms / 10 || rx[4] > ENC_LONG_PRESS_MAX_ms / 10
+          || rx[5] >= UNI_MODES || rx[6] > NEO_RING_GAUGE) {
+          status = RAW_ERR_ARG;                             // keep and echo old values
+          break;
+        }
+        for(i=0; i<len; i++) set[ofs + i] = rx[1 + i];
+        SET_modified();
+      }
+      break;
+
+    case RAW_CMD_GET_STAT:
+      *(__xdata uint16_t*)(tx + 2) = TIM_millis();
+      *(__xdata uint16_t*)(tx + 4) = STAT_scanRate;
+      *(__xdata uint16_t*)(tx + 6) = STAT_reports;
+      *(__xdata uint16_t*)(tx + 8) = STAT_configTime;
+      *(__xdata uint16_t*)(tx + 10) = STAT_firstReport;
+      break;
+
+    case RAW_CMD_DEFAULTS:
+      SET_init();
+      SET_modified();
+      break;
+
+    case RAW_CMD_LED_FRAME:
+      if(*(__xdata uint16_t*)(rx + 2) >= NEO_COUNT || rx[4] > (RAW_SIZE - 6) / 3
+        || rx[4] > NEO_COUNT - *(__xdata uint16_t*)(rx + 2)) {
+        status = RAW_ERR_ARG;
+        break;
+      }
+      if(!LED_frame(rx + 1)) status = RAW_ERR_SEQ;
+      tx[2] = LED_shownSeq;
+      break;
+
+    case RAW_CMD_GAUGE:
+      if(rx[1]) LED_gaugeLevel = rx[2];                     // redrawn by main loop
+      tx[2] = LED_gaugeLevel;
+      break;
+
+    default:
+      status = RAW_ERR_CMD;
+      break;
+  }
+
+  tx[1] = status;
+  for(i=0; i<len; i++) tx[2 + i] = set[ofs + i];            // echo current values
+}
+
+// Execute pending commands and queue responses
+void RAW_process(void) {
+  #if USB_WEBUSB
+  uint8_t i, seq;
+  if(RAW_ctrlReadyFlag) {                                   // command via control transfer
+    IE_USB = 0;
+    seq = RAW_ctrlSeq;                                      // EP0 buffer is only valid
+    if(RAW_ctrlReadyFlag) {                                 // until the next SETUP
+      for(i=RAW_ctrlLen; i<RAW_SIZE; i++) EP0_buffer[i] = 0;// pad short command
+      IE_USB = 1;
+      RAW_execute(EP0_buffer, RAW_ctrlTxBuffer);
+      IE_USB = 0;
+      if(RAW_ctrlReadyFlag && seq == RAW_ctrlSeq) {         // no new SETUP or reset?
+        RAW_ctrlDoneFlag  = 1;                              // response can be fetched
+        RAW_ctrlReadyFlag = 0;
+        UEP0_T_LEN = 0;                                     // release status stage
+        UEP0_CTRL  = UEP0_CTRL & ~MASK_UEP_T_RES | UEP_T_RES_ACK;
+      }
+    }
+    IE_USB = 1;
+  }
+  #endif
+  if(!RAW_readyFlag || RAW_writeBusyFlag) return;           // nothing to do yet
+  RAW_execute(RAW_rxBuffer, RAW_txBuffer);
+  RAW_readyFlag     = 0;
+  RAW_writeBusyFlag = 1;
+  UEP3_T_LEN = RAW_SIZE;                                    // EP3 interrupts can't occur
+  UEP3_CTRL  = UEP3_CTRL & ~(MASK_UEP_T_RES | MASK_UEP_R_RES)   // here, both are NAKing
+             | UEP_T_RES_ACK | UEP_R_RES_ACK;               // upload, accept next command
+}
+
+// ===================================================================================
+// Raw HID USB Handler Functions
+// ===================================================================================
+
+// Drop pending commands and responses (USB bus reset)
+void RAW_reset(void) {
+  RAW_readyFlag     = 0;
+  RAW_writeBusyFlag = 0;
+  #if USB_WEBUSB
+  RAW_ctrlOutFlag   = 0;
+  RAW_ctrlReadyFlag = 0;
+  RAW_ctrlDoneFlag  = 0;
+  #endif
+}
+
+// Endpoint 3 IN handler (response transfer to host)
+void RAW_EP3_IN(void) {
+  UEP3_T_LEN = 0;                                           // no data to send anymore
+  UEP3_CTRL = UEP3_CTRL & ~MASK_UEP_T_RES | UEP_T_RES_NAK;  // default NAK
+  RAW_writeBusyFlag = 0;                                    // clear busy flag
+}
+
+// Endpoint 3 OUT handler (command transfer from host)
+void RAW_EP3_OUT(void) {
+  if(U_TOG_OK) {                                            // synchronized packet?
+    UEP3_CTRL = UEP3_CTRL & ~MASK_UEP_R_RES | UEP_R_RES_NAK;// hold until processed
+    RAW_readyFlag = 1;
+  }
+}
+
+#if USB_WEBUSB
+// ===================================================================================
+// Vendor Interface Control Transfers (WebUSB, WinUSB)
+// ===================================================================================
+
+// Handle vendor request to the vendor interface, return length of data or 0xFF to stall
+uint8_t RAW_CTRL_request(void) {
+  uint8_t i, len;
+  switch(SetupReq) {
+    case RAW_REQ_COMMAND:                                   // command in data stage
+      if(RAW_ctrlReadyFlag || !SetupLen || SetupLen > RAW_SIZE) return 0xFF;
+      RAW_ctrlDoneFlag = 0;                                 // drop unfetched response
+      RAW_ctrlOutFlag  = 1;
+      return 0;
+
+    case RAW_REQ_RESPONSE:                                  // response, empty if pending
+      if(!RAW_ctrlDoneFlag) return 0;
+      len = SetupLen < RAW_SIZE ? SetupLen : RAW_SIZE;
+      for(i=0; i<len; i++) EP0_buffer[i] = RAW_ctrlTxBuffer[i];
+      RAW_ctrlDoneFlag = 0;
+      return len;
+
+    default:
+      return 0xFF;                                          // request not supported
+  }
+}
+
+// Handle data stage of command request, return 1 if it was consumed. The command is
+// executed by RAW_process() right in the EP0 buffer instead of being copied here, the
+// caller answers the status stage with NAK until then, so the host can't send the
+// next request meanwhile.
+uint8_t RAW_CTRL_OUT(void) {
+  if(!RAW_ctrlOutFlag) return 0;                            // no command pending
+  RAW_ctrlLen       = USB_RX_LEN;
+  RAW_ctrlOutFlag   = 0;
+  RAW_ctrlReadyFlag = 1;                                    // execute in main loop
+  return 1;
+}
+
+// Drop command whose transfer was aborted by a new SETUP, which overwrites the EP0
+// buffer. A command executed meanwhile does not release the new transfer.
+void RAW_CTRL_cancel(void) {
+  RAW_ctrlOutFlag   = 0;
+  RAW_ctrlReadyFlag = 0;
+  RAW_ctrlSeq++;
+}
+#endif // USB_WEBUSB
@@ -0,0 +1,92 @@
+// ===================================================================================
+// USB Raw HID Configuration Interface for CH551, CH552 and CH554
+// ===================================================================================
+//
+// Vendor-defined HID interface with 64-byte interrupt IN/OUT endpoints (EP3). The
+// host sends a command packet, the device answers with a response packet. Received
+// commands are only flagged by the USB interrupt and executed by RAW_process(),
+// which must be called from the main loop. Further command packets are NAKed until
+// the response has been queued, so the scan loop is never blocked.
+//
+// Command packet  (host -> device): [cmd] [arguments ...]
+// Response packet (device -> host): [cmd] [status] [data ...]
+//
+// Command           Arguments                       Response data
+// RAW_CMD_INFO      -                               ver(2) slots keys settings-size
+//                                                   protocol
+// RAW_CMD_GET_MAP   first count                     count * (type code param)
+// RAW_CMD_SET_MAP   first count count*(type code param)
+// RAW_CMD_GET_LED   -                               hue(6) brightKeys brightEnc
+// RAW_CMD_SET_LED   hue(6) brightKeys brightEnc
+// RAW_CMD_GET_PAR   -                               scanDelay encDebounce clickGap
+//                                                   longPress uniMode ringMode
+// RAW_CMD_SET_PAR   scanDelay encDebounce clickGap longPress uniMode ringMode
+// RAW_CMD_GET_STAT  -                               millis(2) scanRate(2) reports(2)
+//                                                   configTime(2) firstReport(2)
+// RAW_CMD_DEFAULTS  -                               -
+// RAW_CMD_LED_FRAME seq first(2) count flags        shownSeq
+//                   count*(r g b)
+// RAW_CMD_GAUGE     set level                       level
+// Values out of range (keymap entry type and code, hue 0..191, brightness 0..2,
+// timing parameters within the limits in config.h, Unicode input method, ring
+// mode) are rejected with RAW_ERR_ARG, the current values are returned unchanged
+// then and nothing is written.
+// All 16-bit values are little-endian, all packets are 64 bytes long. Changed
+// settings are written to DataFlash SET_SAVE_DELAY_ms after the last change.
+// RAW_CMD_LED_FRAME writes up to 19 pixels of a host-driven frame, it is not
+// stored (see ledstream.h). Protocol 2 moved it from 0x09 to 0x0B when the first
+// pixel became 16-bit, tools sending the old 8-bit format get RAW_ERR_CMD instead
+// of misplaced pixels. RAW_CMD_GAUGE reads the level of the encoder ring gauge
+// and with set != 0 writes it first, the level is not stored either.
+//
+// With USB_WEBUSB set, the same commands are also accepted via vendor control
+// transfers to the vendor interface (USB_VENDOR_INTERFACE), which browsers (WebUSB)
+// and Windows (WinUSB, installed automatically via the MS OS 2.0 descriptors) can
+// open without a driver, unlike the HID interface:
+// bmRequestType 0x41, bRequest RAW_REQ_COMMAND,  wLength 1..64: command packet
+// bmRequestType 0xC1, bRequest RAW_REQ_RESPONSE, wLength 64:    response packet
+// The response request returns no data until the command has been executed by
+// RAW_process(), the host repeats it until the response arrives.
+
+#pragma once
+#include <stdint.h>
+#include "config.h"
+
+#define RAW_SIZE            64      // packet size (EP3_SIZE)
+#define RAW_PROTOCOL        2       // protocol version, bumped on incompatible changes
+
+// Commands
+#define RAW_CMD_INFO        0x00    // get firmware and settings information
+#define RAW_CMD_GET_MAP     0x01    // read keymap entries
+#define RAW_CMD_SET_MAP     0x02    // write keymap entries
+#define RAW_CMD_GET_LED     0x03    // read key colors and brightness
+#define RAW_CMD_SET_LED     0x04    // write key colors and brightness
+#define RAW_CMD_GET_PAR     0x05    // read debounce/scan parameters
+#define RAW_CMD_SET_PAR     0x06    // write debounce/scan parameters
+#define RAW_CMD_GET_STAT    0x07    // read runtime statistics
+#define RAW_CMD_DEFAULTS    0x08    // restore compiled-in settings
+                                    // 0x09: frame with 8-bit first pixel (protocol 1)
+#define RAW_CMD_GAUGE       0x0A    // read/write encoder ring gauge level
+#define RAW_CMD_LED_FRAME   0x0B    // write pixels of host-driven frame
+
+// Vendor requests to the vendor interface (USB_WEBUSB)
+#define RAW_REQ_COMMAND     0x01    // host -> device: command packet
+#define RAW_REQ_RESPONSE    0x02    // device -> host: response packet
+
+// Response status
+#define RAW_OK              0x00    // command executed
+#define RAW_ERR_CMD         0x01    // unknown command
+#define RAW_ERR_ARG         0x02    // invalid argument
+#define RAW_ERR_SEQ         0x03    // stale frame sequence number
+
+extern volatile __bit RAW_readyFlag;        // command packet received
+extern volatile __bit RAW_writeBusyFlag;    // response upload busy flag
+
+void RAW_process(void);                     // execute pending command (call in loop)
+void RAW_reset(void);                       // drop pending commands (bus reset)
+
+#if USB_WEBUSB
+uint8_t RAW_CTRL_request(void);             // vendor request (SETUP stage)
+uint8_t RAW_CTRL_OUT(void);                 // vendor request (data stage)
+void RAW_CTRL_cancel(void);                 // drop pending command (new SETUP)
+#endif
@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   kbdlayout - Keyboard Layout Table Generator for CH55x Firmware
+# Version:   v1.0
+# Year:      2023
+# License:   MIT License
+# ===================================================================================
+#
+# Description:
+# ------------
+# Builds the ASCII to keycode tables in src/kbd_layout.c/.h from the layout specs in
+# tools/layouts/*.txt. The layout is selected with KBD_LAYOUT in src/config.h. Per
+# character the tables hold the keycode and the shift bit (KBD_map, 1 byte) and the
+# AltGr and dead key flags (KBD_mapExt, 2 bits), so the lookup is O(1).
+#
+# Every generated table is decoded again and compared with its spec before anything
+# is written. tools/tests/test_kbdstr.py checks the generated src/kbd_layout.c end to
+# end by typing every character and decoding the keycodes as the host would.
+#
+# Layout spec format:
+# # country N                    HID country code of the layout
+# keycode normal shift altgr     characters of a key, '-' none, '\-' minus,
+#                                '\\' backslash, '*x' dead key x (typed by x + space)
+#
+# Operating Instructions:
+# -----------------------
+# Run "make layouts" or "python3 tools/kbdlayout.py" after changing a layout spec.
+# tools/kbdstr.py uses the same specs to encode the macro strings.
+
+import os
+import re
+import sys
+
+LAYOUTS = ['us', 'uk', 'de', 'fr', 'nordic']    # order defines KBD_LAYOUT_xx values
+SPEC_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'layouts')
+
+SHIFT, ALTGR = 0x02, 0x40                       # left shift, right alt modifier bits
+EXT_ALTGR, EXT_DEAD = 0x01, 0x02
+CONTROL = {'\b': 0x2A, '\t': 0x2B, '\n': 0x28, ' ': 0x2C}
+
+
+def load(name):
+    """Return (country, dict char -> (modifiers, keycode, dead)) of a layout."""
+    path = os.path.join(SPEC_DIR, name + '.txt')
+    country, keys = 0, {}
+    with open(path, encoding='utf-8') as f:
+        for n, line in enumerate(f, 1):
+            m = re.match(r'#\s*country\s+(\d+)', line)
+            if m:
+                country = int(m.group(1))
+            if not line.strip() or line.startswith('#'):
+                continue
+            cols = line.split()
+            if len(cols) != 4:
+                sys.exit('%s:%d: expected 4 columns' % (path, n))
+            code = int(cols[0], 16)
+            for mod, tok in zip((0, SHIFT, ALTGR), cols[1:]):
+                if tok == '-':
+                    continue
+                dead = len(tok) == 2 and tok[0] == '*'
+                char = tok[1:] if dead or tok in ('\\-', '\\\\') else tok
+                if len(char) != 1:
+                    sys.exit('%s:%d: bad character %r' % (path, n, tok))
+                keys.setdefault(char, (mod, code, dead))    # first one wins
+    for char, code in CONTROL.items():
+        keys[char] = (0, code, False)
+    return country, keys
+
+
+def tables(keys):
+    """Build KBD_map[128] and KBD_mapExt[32] for the ASCII part of a layout."""
+    kmap, ext = [0] * 128, [0] * 32
+    for c in range(128):
+        if chr(c) not in keys:
+            continue
+        mod, code, dead = keys[chr(c)]
+        if code > 0x7F:
+            sys.exit('kbdlayout: keycode 0x%02x of %r does not fit' % (code, chr(c)))
+        kmap[c] = code | (0x80 if mod & SHIFT else 0)
+        flags = (EXT_ALTGR if mod & ALTGR else 0) | (EXT_DEAD if dead else 0)
+        ext[c >> 2] |= flags << ((c & 3) << 1)
+    return kmap, ext
+
+
+def check(name, keys, kmap, ext):
+    """Decode the tables again and compare with the layout spec (round trip)."""
+    inverse = {}
+    for char, entry in keys.items():
+        inverse.setdefault(entry, char)
+    for c in range(128):
+        if not kmap[c]:
+            if chr(c) in keys:
+                sys.exit('kbdlayout: %s: %r lost' % (name, chr(c)))
+            continue
+        flags = (ext[c >> 2] >> ((c & 3) << 1)) & 3
+        mod = (SHIFT if kmap[c] & 0x80 else 0) | (ALTGR if flags & EXT_ALTGR else 0)
+        entry = (mod, kmap[c] & 0x7F, bool(flags & EXT_DEAD))
+        if inverse.get(entry) != chr(c):
+            sys.exit('kbdlayout: %s: round trip of %r failed' % (name, chr(c)))
+    return [chr(c) for c in range(32, 127) if not kmap[c]]
+
+
+def c_array(name, data, per_line=14):
+    out = ['  __code uint8_t %s[%d] = {' % (name, len(data))]
+    for i in range(0, len(data), per_line):
+        out.append('    ' + ', '.join('0x%02x' % b for b in data[i:i + per_line]) +
+                   (',' if i + per_line < len(data) else ''))
+    return out + ['  };']
+
+
+def main():
+    src = sys.argv[1] if len(sys.argv) > 1 else 'src'
+    banner = ['// ' + '=' * 83,
+              '// Keyboard Layout Tables (generated by tools/kbdlayout.py, do not edit)',
+              '// ' + '=' * 83]
+    h = banner + [
+        '//',
+        '// KBD_map[c]:    keycode of ASCII character c, bit 7 set if shift is needed',
+        '// KBD_mapExt[]:  two bits per character, KBD_EXT_ALTGR and KBD_EXT_DEAD',
+        '//',
+        '// The layout is selected with KBD_LAYOUT in config.h.',
+        '',
+        '#pragma once',
+        '#include <stdint.h>',
+        '#include "config.h"',
+        '']
+    h += ['#define KBD_LAYOUT_%-8s %d' % (n.upper(), i) for i, n in enumerate(LAYOUTS)]
+    h += ['', '#define KBD_EXT_ALTGR       0x%02x     // needs AltGr (right alt)' % EXT_ALTGR,
+          '#define KBD_EXT_DEAD        0x%02x     // dead key, must be followed by space'
+          % EXT_DEAD,
+          '#define KBD_getExt(c)       ((KBD_mapExt[(c) >> 2] >> (((c) & 3) << 1)) & 3)',
+          '']
+    c = banner + ['', '#include "kbd_layout.h"', '']
+    for i, name in enumerate(LAYOUTS):
+        country, keys = load(name)
+        kmap, ext = tables(keys)
+        missing = check(name, keys, kmap, ext)
+        cond = '#if  ' if i == 0 else '#elif'
+        h += ['%s KBD_LAYOUT == KBD_LAYOUT_%s' % (cond, name.upper()),
+              '  #define KBD_COUNTRY_CODE  %d' % country]
+        c += ['%s KBD_LAYOUT == KBD_LAYOUT_%s' % (cond, name.upper())]
+        if missing:
+            c += ['  // not available: ' + ' '.join(missing)]
+        c += c_array('KBD_map', kmap) + c_array('KBD_mapExt', ext)
+        print('kbdlayout: %-7s ok%s' % (name, ', missing ' + ''.join(missing)
+                                       if missing else ''))
+    h += ['#else', '  #error Unknown KBD_LAYOUT in config.h', '#endif', '',
+          'extern __code uint8_t KBD_map[128];',
+          'extern __code uint8_t KBD_mapExt[32];', '']
+    c += ['#endif', '']
+    with open(os.path.join(src, 'kbd_layout.h'), 'w') as f:
+        f.write('\n'.join(h))
+    with open(os.path.join(src, 'kbd_layout.c'), 'w') as f:
+        f.write('\n'.join(c))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,263 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   kbdstr - Keyboard Macro String Compiler for CH55x Firmware
+# Version:   v1.0
+# Year:      2023
+# License:   MIT License
+# ===================================================================================
+#
+# Description:
+# ------------
+# Converts the macro strings in src/kbd_strings.txt into pre-encoded keyboard
+# streams (src/kbd_strings.c and src/kbd_strings.h), which are typed by KBD_play()
+# without any runtime conversion. Each character is translated into a (modifier,
+# keycode) pair according to the keyboard layout selected in src/config.h (see
+# tools/kbdlayout.py), dead keys are followed by a space. Repeated characters are
+# run-length packed, shared substrings are stored only once and called from every
+# string which contains them, identical strings share the same stream.
+# tools/tests/test_kbdstr.py plays the streams back and decodes them to text.
+#
+# Stream format (one __code byte array KBD_strings[]):
+# 0x00          end of string (or return from fragment)
+# 0x04..0xE7    type keycode with current modifiers
+# 0xF0 m        set modifiers to m
+# 0xF1 n k      type keycode k n times with current modifiers
+# 0xF2 lo hi    call fragment at offset (fragments start with modifiers 0 and
+#               can't call other fragments, modifiers are restored on return)
+# 0xF3 m k      type keycode k once with modifiers m
+#
+# String file format:
+# NAME "text"   one string per line (UTF-8), C escapes \n \t \b \\ \" \xHH are
+#               allowed, lines starting with # are comments. Non-ASCII characters
+#               can be used if the selected layout has them (e.g. umlauts on DE).
+#
+# Operating Instructions:
+# -----------------------
+# The makefile runs the compiler whenever src/kbd_strings.txt or the layout has
+# changed. Run "make strings" or "python3 tools/kbdstr.py [src/kbd_strings.txt]"
+# manually when compiling with the Arduino IDE.
+
+import os
+import re
+import sys
+
+import kbdlayout
+
+OP_END, OP_MOD, OP_REP, OP_CALL, OP_ONCE = 0x00, 0xF0, 0xF1, 0xF2, 0xF3
+MIN_REPEAT   = 4                    # min run length worth a repeat op
+MIN_FRAGMENT = 4                    # min number of keys worth a fragment call
+
+
+# ===================================================================================
+# Keyboard Layout
+# ===================================================================================
+def selected_layout(config):
+    """Return layout name selected with KBD_LAYOUT in config.h."""
+    with open(config) as f:
+        m = re.search(r'^#define\s+KBD_LAYOUT\s+KBD_LAYOUT_(\w+)', f.read(), re.M)
+    if not m:
+        sys.exit('kbdstr: KBD_LAYOUT not found in ' + config)
+    return m.group(1).lower()
+
+
+# ===================================================================================
+# Parsing and Encoding
+# ===================================================================================
+LINE = re.compile(r'^\s*([A-Za-z_]\w*)\s+"((?:[^"\\]|\\.)*)"\s*$')
+
+
+def unescape(text):
+    return re.sub(r'\\(x[0-9a-fA-F]{2}|.)',
+                  lambda m: chr(int(m.group(1)[1:], 16)) if m.group(1)[0] == 'x'
+                  else {'n': '\n', 't': '\t', 'b': '\b'}.get(m.group(1), m.group(1)),
+                  text)
+
+
+def parse(path):
+    strings = []
+    with open(path, encoding='utf-8') as f:
+        for n, line in enumerate(f, 1):
+            if not line.strip() or line.lstrip().startswith('#'):
+                continue
+            m = LINE.match(line)
+            if not m:
+                sys.exit('%s:%d: syntax error' % (path, n))
+            strings.append((m.group(1), unescape(m.group(2))))
+    return strings
+
+
+def to_keys(name, text, layout):
+    keys = []
+    for c in text:
+        if c not in layout:
+            sys.exit('kbdstr: %s: character %r not in keyboard layout' % (name, c))
+        mod, code, dead = layout[c]
+        keys.append((mod, code))
+        if dead:
+            keys.append((0, kbdlayout.CONTROL[' ']))
+    return keys
+
+
+def extract_fragments(seqs):
+    """Replace shared substrings by ('call', n) tokens, return fragment list."""
+    frags = []
+    while True:
+        best, best_gain = None, 0
+        runs = []                                   # raw key runs between calls
+        for s in seqs:
+            start = 0
+            for i, t in enumerate(s + [('call', -1)]):
+                if t[0] == 'call':
+                    if i - start >= MIN_FRAGMENT:
+                        runs.append(tuple(s[start:i]))
+                    start = i + 1
+        seen = set()
+        for run in runs:
+            for a in range(len(run)):
+                for b in range(a + MIN_FRAGMENT, len(run) + 1):
+                    sub = run[a:b]
+                    if sub in seen:
+                        continue
+                    seen.add(sub)
+                    occ = sum(count_occ(r, sub) for r in runs)
+                    if occ < 2:
+                        continue
+                    size = len(encode(list(sub), [])) - 1
+                    gain = occ * (size - 3) - (size + 1)
+                    if gain > best_gain:
+                        best, best_gain = sub, gain
+        if not best:
+            return frags
+        frags.append(list(best))
+        seqs[:] = [replace(s, best, ('call', len(frags) - 1)) for s in seqs]
+
+
+def count_occ(run, sub):
+    n, i = 0, 0
+    while i + len(sub) <= len(run):
+        if run[i:i + len(sub)] == sub:
+            n, i = n + 1, i + len(sub)
+        else:
+            i += 1
+    return n
+
+
+def replace(seq, sub, token):
+    out, i = [], 0
+    while i < len(seq):
+        if tuple(seq[i:i + len(sub)]) == sub and all(t[0] != 'call' for t in sub):
+            out.append(token)
+            i += len(sub)
+        else:
+            out.append(seq[i])
+            i += 1
+    return out
+
+
+def encode(seq, frag_offsets):
+    out, mod, i = [], 0, 0
+    while i < len(seq):
+        t = seq[i]
+        if t[0] == 'call':
+            off = frag_offsets[t[1]]
+            out += [OP_CALL, off & 0xFF, off >> 8]
+            i += 1
+            continue
+        n = 1
+        while i + n < len(seq) and seq[i + n] == t and n < 255:
+            n += 1
+        if t[0] != mod:
+            if n == 1 and (i + 1 == len(seq) or seq[i + 1][0] != t[0]):
+                out += [OP_ONCE, t[0], t[1]]        # single key with other modifiers
+                i += 1
+                continue
+            out += [OP_MOD, t[0]]
+            mod = t[0]
+        if n >= MIN_REPEAT:
+            out += [OP_REP, n, t[1]]
+            i += n
+        else:
+            out.append(t[1])
+            i += 1
+    return out + [OP_END]
+
+
+def build(strings, layout):
+    names, unique, alias = [], [], {}
+    for name, text in strings:
+        if text in alias:
+            names.append((name, text, alias[text]))
+        else:
+            alias[text] = len(unique)
+            names.append((name, text, len(unique)))
+            unique.append(to_keys(name, text, layout))
+    seqs = [list(s) for s in unique]
+    frags = extract_fragments(seqs)
+
+    # fragments first, so their offsets are known when encoding the strings
+    data, frag_offsets, blocks = [], [], []
+    for f in frags:
+        frag_offsets.append(len(data))
+        enc = encode(f, frag_offsets)
+        blocks.append(('fragment %d' % (len(frag_offsets) - 1), len(data), enc))
+        data += enc
+    offsets = []
+    for n, s in enumerate(seqs):
+        offsets.append(len(data))
+        enc = encode(s, frag_offsets)
+        label = ', '.join(nm for nm, _, u in names if u == n)
+        blocks.append((label, len(data), enc))
+        data += enc
+    return names, offsets, blocks, data
+
+
+# ===================================================================================
+# Output
+# ===================================================================================
+HEADER = '''// ===================================================================================
+// Keyboard Macro Strings (generated by tools/kbdstr.py from %s, do not edit)
+// ===================================================================================
+'''
+
+
+def c_text(text):
+    return text.encode('unicode_escape').decode().replace('"', '\\"')
+
+
+def write(path_c, path_h, source, names, offsets, blocks, data):
+    src = os.path.basename(source)
+    with open(path_h, 'w', encoding='utf-8') as f:
+        f.write(HEADER % src)
+        f.write('//\n// Type a string with KBD_play(NAME).\n\n')
+        f.write('#pragma once\n#include <stdint.h>\n\n')
+        f.write('extern __code uint8_t KBD_strings[];\n\n')
+        for name, text, u in names:
+            f.write('#define %-20s (KBD_strings + %d)   // "%s"\n'
+                    % (name, offsets[u], c_text(text)))
+    with open(path_c, 'w', encoding='utf-8') as f:
+        f.write(HEADER % src)
+        f.write('\n#include "kbd_strings.h"\n\n')
+        f.write('__code uint8_t KBD_strings[] = {\n')
+        for label, start, enc in blocks:
+            f.write('  // %s (offset %d)\n' % (label, start))
+            for i in range(0, len(enc), 12):
+                f.write('  ' + ' '.join('0x%02x,' % b for b in enc[i:i + 12]) + '\n')
+        if not data:
+            f.write('  0x00\n')
+        f.write('};\n')
+
+
+def main():
+    source = sys.argv[1] if len(sys.argv) > 1 else 'src/kbd_strings.txt'
+    base = os.path.splitext(source)[0]
+    name = selected_layout(os.path.join(os.path.dirname(source), 'config.h'))
+    strings = parse(source)
+    names, offsets, blocks, data = build(strings, kbdlayout.load(name)[1])
+    write(base + '.c', base + '.h', source, names, offsets, blocks, data)
+    plain = sum(len(t) + 1 for _, t in strings)
+    print('kbdstr: %d string(s), %d bytes (%d characters), layout %s'
+          % (len(strings), len(data), plain, name.upper()))
+
+
+if __name__ == '__main__':
+    main()
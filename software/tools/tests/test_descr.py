@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   test_descr - Host-Side Test of the HID Report Descriptors
+# Version:   v1.0
+# Year:      2023
+# License:   MIT License
+# ===================================================================================
+#
+# Description:
+# ------------
+# Runs src/usb_descr.c and src/usb_composite.c through the host C preprocessor (with
+# the settings of src/config.h and the makefile), parses the HID report descriptors
+# item by item and checks them against the report buffers of the firmware:
+# - collections are balanced and all items are complete
+# - every input report of the composite interface is a whole number of bytes and
+#   has exactly the length of the report buffer with the same report ID
+# - the fields written by the firmware are where the firmware writes them (e.g.
+#   the 15-bit dial of the radial controller behind its button bit)
+# - keyboard LED output and resolution multiplier feature reports have the length
+#   the class request handlers expect
+# - the Raw HID reports have the size of the endpoint
+#
+# Operating Instructions:
+# -----------------------
+# Run "make test" or "python3 tools/tests/test_descr.py" in the software folder.
+# Needs a host C compiler ("cc", or set CC) for preprocessing only.
+
+import os
+import re
+import shlex
+import subprocess
+import sys
+import unittest
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..')
+SRC  = os.path.join(ROOT, 'src')
+
+# HID item tags
+MAIN_INPUT, MAIN_OUTPUT, MAIN_FEATURE  = 0x8, 0x9, 0xB
+MAIN_COLLECTION, MAIN_END              = 0xA, 0xC
+GLOBAL_USAGE_PAGE, GLOBAL_REPORT_SIZE  = 0x0, 0x7
+GLOBAL_REPORT_ID, GLOBAL_REPORT_COUNT  = 0x8, 0x9
+LOCAL_USAGE, LOCAL_USAGE_MIN           = 0x0, 0x1
+KINDS = {MAIN_INPUT: 'input', MAIN_OUTPUT: 'output', MAIN_FEATURE: 'feature'}
+
+
+def makefile_value(name):
+    """Return value of a variable in the makefile."""
+    with open(os.path.join(ROOT, 'makefile')) as f:
+        for line in f:
+            m = re.match(r'^%s\s*=\s*(\S+)' % name, line)
+            if m:
+                return m.group(1)
+    raise KeyError(name)
+
+
+def preprocess(filename):
+    """Return source file after running it through the C preprocessor."""
+    cc = shlex.split(os.environ.get('CC', 'cc'))
+    cmd = cc + ['-E', '-P', '-I' + SRC,
+                '-DF_CPU=' + makefile_value('FREQ_SYS'),
+                '-DUSB_RAM_SIZE=' + makefile_value('XRAM_LOC'),
+                os.path.join(SRC, filename)]
+    return subprocess.run(cmd, check=True, capture_output=True, text=True).stdout
+
+
+def array(source, name):
+    """Return values of a byte array initializer in preprocessed source."""
+    m = re.search(r'\b%s\[\]\s*=\s*\{(.*?)\};' % name, source, re.S)
+    if not m:
+        raise KeyError(name)
+    return [eval(v.strip()) & 0xFF for v in m.group(1).split(',') if v.strip()]
+
+
+def parse(descr):
+    """Parse report descriptor, return {(kind, id): [field, ...]} with fields as
+    dicts (page, usage, size, count, offset, const) and the collection depth."""
+    reports, state, usages, depth, i = {}, {}, [], 0, 0
+    while i < len(descr):
+        prefix = descr[i]
+        size   = (0, 1, 2, 4)[prefix & 3]
+        kind   = (prefix >> 2) & 3
+        tag    = prefix >> 4
+        if i + 1 + size > len(descr):
+            raise ValueError('incomplete item at offset %d' % i)
+        data = int.from_bytes(bytes(descr[i + 1:i + 1 + size]), 'little')
+        i += 1 + size
+        if kind == 0:                                       # main item
+            if tag in KINDS:
+                key    = (KINDS[tag], state.get(GLOBAL_REPORT_ID, 0))
+                fields = reports.setdefault(key, [])
+                offset = sum(f['size'] * f['count'] for f in fields)
+                fields.append({'page':   state.get(GLOBAL_USAGE_PAGE),
+                               'usage':  usages[0] if usages else None,
+                               'size':   state[GLOBAL_REPORT_SIZE],
+                               'count':  state[GLOBAL_REPORT_COUNT],
+                               'offset': offset,
+                               'const':  bool(data & 1)})
+            elif tag == MAIN_COLLECTION:
+                depth += 1
+            elif tag == MAIN_END:
+                depth -= 1
+                if depth < 0:
+                    raise ValueError('END_COLLECTION without COLLECTION')
+            usages = []                                     # locals end with main item
+        elif kind == 1:                                     # global item
+            state[tag] = data
+        elif kind == 2 and tag in (LOCAL_USAGE, LOCAL_USAGE_MIN):
+            usages.append(data)
+    return reports, depth
+
+
+def field(fields, page, usage):
+    """Return the field with the given first usage."""
+    for f in fields:
+        if f['page'] == page and f['usage'] == usage:
+            return f
+    raise KeyError((page, usage))
+
+
+class ReportDescriptorTest(unittest.TestCase):
+
+    @classmethod
+    def setUpClass(cls):
+        descr = preprocess('usb_descr.c')
+        comp  = preprocess('usb_composite.c')
+        cls.reports, cls.depth = parse(array(descr, 'ReportDescr'))
+        cls.raw, cls.rawDepth  = parse(array(descr, 'RawReportDescr'))
+        cls.buffers = {}
+        for name in re.findall(r'\b(\w+_report)\[\]\s*=', comp):
+            buf = array(comp, name)
+            cls.buffers[buf[0]] = (name, len(buf))
+
+    def bits(self, kind, rid):
+        return sum(f['size'] * f['count'] for f in self.reports[(kind, rid)])
+
+    def test_collections_balanced(self):
+        self.assertEqual(self.depth, 0)
+        self.assertEqual(self.rawDepth, 0)
+
+    def test_input_reports_match_buffers(self):
+        ids = sorted(rid for kind, rid in self.reports if kind == 'input')
+        self.assertEqual(ids, sorted(self.buffers))
+        for rid in ids:
+            name, length = self.buffers[rid]
+            with self.subTest(report=name):
+                self.assertEqual(self.bits('input', rid) % 8, 0)
+                self.assertEqual(self.bits('input', rid) // 8 + 1, length)
+
+    def test_no_report_id_zero(self):
+        for kind, rid in self.reports:
+            self.assertNotEqual(rid, 0)
+
+    def test_keyboard_leds(self):
+        self.assertEqual(self.bits('output', 1), 8)        # LED byte after ID
+
+    def test_mouse_fields(self):
+        fields = self.reports[('input', 3)]
+        self.assertEqual(field(fields, 0x01, 0x30)['offset'], 8)   # X at byte 2
+        self.assertEqual(field(fields, 0x01, 0x30)['size'], 16)
+        self.assertEqual(field(fields, 0x01, 0x38)['offset'], 40)  # wheel at byte 6
+        self.assertEqual(field(fields, 0x0C, 0x238)['offset'], 48) # pan at byte 7
+
+    def test_resolution_multiplier(self):
+        self.assertEqual(self.bits('feature', 3), 8)       # one byte after ID
+        fields = self.reports[('feature', 3)]
+        mult = [f for f in fields if f['usage'] == 0x48]
+        self.assertEqual([f['offset'] for f in mult], [0, 2])  # wheel, pan bits
+
+    def test_radial_controller(self):
+        fields = self.reports[('input', 5)]
+        button = field(fields, 0x09, 0x01)
+        dial   = field(fields, 0x01, 0x37)
+        self.assertEqual((button['offset'], button['size']), (0, 1))
+        self.assertEqual((dial['offset'], dial['size']), (1, 15))
+
+    def test_raw_hid(self):
+        self.assertEqual(sum(f['size'] * f['count'] for f in self.raw[('input', 0)]), 512)
+        self.assertEqual(sum(f['size'] * f['count'] for f in self.raw[('output', 0)]), 512)
+
+
+if __name__ == '__main__':
+    os.chdir(ROOT)
+    sys.exit(unittest.main())
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   test_kbdstr - Host-Side Test of the Keyboard Layouts and Macro Strings
+# Version:   v1.0
+# Year:      2023
+# License:   MIT License
+# ===================================================================================
+#
+# Description:
+# ------------
+# Replays what the firmware sends to the host and decodes it back to text with a
+# table built straight from the layout specs in tools/layouts/*.txt, the way the
+# host would interpret the keycodes:
+# - KBD_type() of every character, using the tables generated into src/kbd_layout.c
+# - KBD_play() of the streams encoded by tools/kbdstr.py for every layout, with
+#   repeats, fragment calls, modifier changes and dead keys
+# - KBD_play() of the generated src/kbd_strings.c for the layout in src/config.h,
+#   which also catches streams that are out of date
+#
+# Operating Instructions:
+# -----------------------
+# Run "make test" or "python3 tools/tests/test_kbdstr.py" in the software folder.
+
+import os
+import re
+import sys
+import unittest
+
+ROOT  = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..')
+SRC   = os.path.join(ROOT, 'src')
+sys.path.insert(0, os.path.join(ROOT, 'tools'))
+
+import kbdlayout
+import kbdstr
+
+SPACE = kbdlayout.CONTROL[' ']
+
+
+def host_table(name):
+    """Return dict (modifiers, keycode) -> (char, dead) as the host sees a layout."""
+    table = {(0, code): (char, False) for char, code in kbdlayout.CONTROL.items()}
+    with open(os.path.join(kbdlayout.SPEC_DIR, name + '.txt'), encoding='utf-8') as f:
+        for line in f:
+            if not line.strip() or line.startswith('#'):
+                continue
+            cols = line.split()
+            for mod, tok in zip((0, kbdlayout.SHIFT, kbdlayout.ALTGR), cols[1:]):
+                if tok != '-':
+                    dead = tok.startswith('*') and len(tok) == 2
+                    table[(mod, int(cols[0], 16))] = (tok[-1], dead)
+    return table
+
+
+def decode(reports, table):
+    """Decode (modifiers, keycode) key strokes to text, dead key + space -> char."""
+    text, i = '', 0
+    while i < len(reports):
+        char, dead = table[reports[i]]
+        if dead:
+            if i + 1 == len(reports) or reports[i + 1] != (0, SPACE):
+                raise ValueError('dead key %r not followed by space' % char)
+            i += 1
+        text += char
+        i += 1
+    return text
+
+
+def firmware_tables(name):
+    """Return KBD_map and KBD_mapExt of a layout from the generated src/kbd_layout.c."""
+    with open(os.path.join(SRC, 'kbd_layout.c')) as f:
+        source = f.read()
+    block = re.search(r'KBD_LAYOUT_%s\n(.*?)(#elif|#endif)' % name.upper(), source, re.S)
+    tables = {}
+    for arr, body in re.findall(r'(KBD_map\w*)\[\d+\]\s*=\s*\{(.*?)\};', block.group(1), re.S):
+        tables[arr] = [int(v, 16) for v in body.replace(',', ' ').split()]
+    return tables['KBD_map'], tables['KBD_mapExt']
+
+
+def kbd_type(c, kmap, ext):
+    """Key strokes of KBD_type(c), like KBD_press()/KBD_release() in usb_composite.c."""
+    flags = (ext[c >> 2] >> ((c & 3) << 1)) & 3
+    key = kmap[c]
+    if not key:
+        return []
+    mod = (kbdlayout.ALTGR if flags & kbdlayout.EXT_ALTGR else 0)
+    mod |= kbdlayout.SHIFT if key & 0x80 else 0
+    out = [(mod, key & 0x7F)]
+    if flags & kbdlayout.EXT_DEAD:
+        out.append((0, SPACE))
+    return out
+
+
+def kbd_play(data, start):
+    """Key strokes of KBD_play(KBD_strings + start), like in usb_composite.c."""
+    out, pos, ret, mod, saved = [], start, None, 0, 0
+    while True:
+        op = data[pos]
+        pos += 1
+        if op == kbdstr.OP_END:
+            if ret is None:
+                return out
+            pos, ret, mod = ret, None, saved
+        elif op == kbdstr.OP_MOD:
+            mod = data[pos]
+            pos += 1
+        elif op == kbdstr.OP_REP:
+            out += [(mod, data[pos + 1])] * data[pos]
+            pos += 2
+        elif op == kbdstr.OP_CALL:
+            if ret is not None:
+                raise ValueError('nested fragment call at offset %d' % (pos - 1))
+            ret, saved, mod = pos + 2, mod, 0
+            pos = data[pos] | data[pos + 1] << 8
+        elif op == kbdstr.OP_ONCE:
+            out.append((data[pos], data[pos + 1]))
+            pos += 2
+        else:
+            out.append((mod, op))
+
+
+class KeyboardLayoutTest(unittest.TestCase):
+
+    def test_type_every_character(self):
+        for name in kbdlayout.LAYOUTS:
+            table = host_table(name)
+            kmap, ext = firmware_tables(name)
+            chars = {c for c, _ in table.values()}
+            for c in range(128):
+                with self.subTest(layout=name, char=chr(c)):
+                    strokes = kbd_type(c, kmap, ext)
+                    if chr(c) in chars:
+                        self.assertEqual(decode(strokes, table), chr(c))
+                    else:
+                        self.assertEqual(strokes, [])
+
+
+class MacroStringTest(unittest.TestCase):
+
+    def check_strings(self, strings, name):
+        names, offsets, blocks, data = kbdstr.build(strings, kbdlayout.load(name)[1])
+        table = host_table(name)
+        for sname, text, u in names:
+            with self.subTest(layout=name, string=sname):
+                self.assertEqual(decode(kbd_play(data, offsets[u]), table), text)
+
+    def test_encode_every_character(self):
+        for name in kbdlayout.LAYOUTS:
+            chars = sorted({c for c, _ in host_table(name).values()})
+            text = ''.join(chars)
+            strings = [('CHARS%d' % i, text[i:i + 24]) for i in range(0, len(text), 24)]
+            strings += [('REPEATS', 'aaaaaaaa' + chars[-1] * 5 + 'AAAA' + '\n' * 300),
+                        ('SHARED1', 'xx' + text[40:52] + 'yy'),
+                        ('SHARED2', text[40:52] + '.' + text[40:52]),
+                        ('ALIAS', text[:24]),
+                        ('EMPTY', '')]
+            self.check_strings(strings, name)
+
+    def test_generated_streams(self):
+        name = kbdstr.selected_layout(os.path.join(SRC, 'config.h'))
+        strings = kbdstr.parse(os.path.join(SRC, 'kbd_strings.txt'))
+        with open(os.path.join(SRC, 'kbd_strings.c')) as f:
+            body = re.search(r'KBD_strings\[\]\s*=\s*\{(.*?)\};', f.read(), re.S).group(1)
+        data = [int(v, 16) for v in re.findall(r'0x[0-9a-fA-F]{2}', body)]
+        with open(os.path.join(SRC, 'kbd_strings.h')) as f:
+            offsets = dict(re.findall(r'#define\s+(\w+)\s+\(KBD_strings \+ (\d+)\)', f.read()))
+        table = host_table(name)
+        self.assertEqual(sorted(offsets), sorted(n for n, _ in strings))
+        for sname, text in strings:
+            with self.subTest(string=sname):
+                self.assertEqual(decode(kbd_play(data, int(offsets[sname])), table), text)
+
+
+if __name__ == '__main__':
+    os.chdir(ROOT)
+    sys.exit(unittest.main())
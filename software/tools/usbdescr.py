@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+# ===================================================================================
+# Project:   usbdescr - USB Descriptor Directory Generator for CH55x Firmware
+# Version:   v1.0
+# Year:      2023
+# License:   MIT License
+# ===================================================================================
+#
+# Description:
+# ------------
+# Scans the descriptor definitions in src/usb_descr.c and (re)builds the descriptor
+# directory at the end of that file. The directory is a __code table of
+# (type, index, pointer, length) entries, which is searched by USB_EP0_SETUP()
+# to answer GET_DESCRIPTOR requests.
+#
+# Descriptors are recognized as follows:
+# - USB_DEV_DESCR ...          device descriptor, index 0
+# - USB_CFG_DESCR...           configuration descriptor, index 0
+# - uint8_t ...ReportDescr[]   HID report descriptor, index = interface number,
+#                              taken from "(Interface N)" in the preceding comment
+# - string descriptors         initializer starts with USB_DESCR_TYP_STRING << 8,
+#                              index taken from "(Index N)" in the preceding comment
+# - anything else              "(Type T, Index N)" in the preceding comment
+# Preprocessor conditionals around descriptor definitions are carried over into the
+# directory, so optional interfaces only appear if they are compiled in.
+#
+# Operating Instructions:
+# -----------------------
+# Run "make descr" or "python3 tools/usbdescr.py [src/usb_descr.c]" after adding,
+# removing or renumbering descriptors.
+
+import re
+import sys
+
+DIR_HEADER = '// Descriptor Directory (generated by tools/usbdescr.py, do not edit)'
+DIR_END    = '// End of Descriptor Directory'
+
+DEFINITION = re.compile(r'^__code\s+(\w+)\s+(\w+)\s*(\[\s*\])?\s*=')
+CONDITION  = re.compile(r'^\s*#\s*(if|ifdef|ifndef|elif|else|endif)\b')
+TAGGED     = re.compile(r'\(Type\s+(\w+),\s*Index\s+(\w+)\)')
+INDEX      = re.compile(r'\(Index\s+(\w+)\)')
+INTERFACE  = re.compile(r'\(Interface\s+(\w+)\)')
+BANNER     = re.compile(r'^//\s*=+\s*$')
+
+
+def classify(ctype, name, comment, head):
+    """Return (type, index) of a descriptor definition or None."""
+    tag = TAGGED.search(comment)
+    if tag:
+        return tag.group(1), tag.group(2)
+    if ctype == 'USB_DEV_DESCR':
+        return 'USB_DESCR_TYP_DEVICE', '0'
+    if ctype.startswith('USB_CFG_DESCR'):
+        return 'USB_DESCR_TYP_CONFIG', '0'
+    if 'USB_DESCR_TYP_STRING' in head:
+        idx = INDEX.search(comment)
+        if not idx:
+            sys.exit('usbdescr: no "(Index N)" comment for string descriptor ' + name)
+        return 'USB_DESCR_TYP_STRING', idx.group(1)
+    if name.endswith('ReportDescr'):
+        itf = INTERFACE.search(comment)
+        return 'USB_DESCR_TYP_REPORT', itf.group(1) if itf else '0'
+    return None
+
+
+def scan(lines):
+    """Collect descriptor entries and preprocessor conditionals in file order."""
+    entries = []
+    comment = ''
+    for n, line in enumerate(lines):
+        if line.startswith(DIR_HEADER):
+            break
+        if CONDITION.match(line):
+            entries.append(line.strip())
+            continue
+        if line.startswith('//'):
+            if not BANNER.match(line):              # section titles may carry the tag
+                comment = line
+            continue
+        m = DEFINITION.match(line)
+        if not m:
+            continue
+        ctype, name, array = m.groups()
+        head = line + (lines[n + 1] if n + 1 < len(lines) else '')
+        kind = classify(ctype, name, comment, head)
+        if kind:
+            ptr = '(__code uint8_t*)' + ('' if array else '&') + name
+            entries.append((kind[0], kind[1], ptr, 'sizeof(%s)' % name))
+        comment = ''
+    # drop conditionals which do not enclose any descriptor
+    result, stack = [], []
+    for e in entries:
+        if isinstance(e, str) and re.match(r'#\s*if', e):
+            stack.append(len(result))
+            result.append(e)
+        elif isinstance(e, str) and re.match(r'#\s*endif', e):
+            start = stack.pop() if stack else None
+            if start is not None and all(isinstance(x, str) for x in result[start:]):
+                del result[start:]
+            else:
+                result.append(e)
+        else:
+            result.append(e)
+    return result
+
+
+def render(entries):
+    out = ['// ' + '=' * 83,
+           DIR_HEADER,
+           '// ' + '=' * 83,
+           '__code USB_DESCR_DIR DescrDir[] = {']
+    for e in entries:
+        if isinstance(e, str):
+            out.append('  ' + e)
+        else:
+            out.append('  { %-22s %-6s %-32s %s },'
+                       % (e[0] + ',', e[1] + ',', e[2] + ',', e[3]))
+    out += ['};',
+            '',
+            '__code uint8_t DescrDirCount = sizeof(DescrDir) / sizeof(USB_DESCR_DIR);',
+            DIR_END]
+    return out
+
+
+def main():
+    path = sys.argv[1] if len(sys.argv) > 1 else 'src/usb_descr.c'
+    with open(path, newline='') as f:
+        text = f.read()
+    eol = '\r\n' if '\r\n' in text else '\n'
+    lines = text.replace('\r\n', '\n').split('\n')
+
+    # cut old directory (including its banner) if present
+    start = next((i for i, l in enumerate(lines) if l.startswith(DIR_HEADER)), None)
+    if start is not None:
+        end = next(i for i, l in enumerate(lines) if l.startswith(DIR_END))
+        lines = lines[:start - 1] + lines[end + 1:]
+        while lines and lines[-1] == '':
+            lines.pop()
+    else:
+        while lines and lines[-1] == '':
+            lines.pop()
+
+    table = render(scan(lines))
+    lines += [''] + table + ['']
+    with open(path, 'w', newline='') as f:
+        f.write(eol.join(lines))
+    print('usbdescr: %d descriptor(s) in directory' %
+          sum(1 for l in table if l.startswith('  {')))
+
+
+if __name__ == '__main__':
+    main()